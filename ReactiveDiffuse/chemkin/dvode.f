@@ -4,6 +4,8 @@
       DOUBLE PRECISION ATOL, RTOL, RWORK, T, TOUT, Y, dt,RPAR
       DIMENSION Y(NSPEC), RWORK(22+9*NSPEC+2*NSPEC**2), IWORK(30+NSPEC)
       DIMENSION RPAR(3)
+C     running statistics, read and reset through getodestats
+      COMMON /ODESTATS/ NODECALL, NODESTEP, NODEFE, NODEJE, NODEFAIL
 
       NEQ = NSPEC
       T = 0.0D0
@@ -21,6 +23,12 @@
         CALL DVODE(FEX,NEQ,Y,T,TOUT,ITOL,RTOL,ATOL,ITASK,ISTATE,
      1            IOPT,RWORK,LRW,IWORK,LIW,JEX,MF,RPAR,IPAR)
 
+      NODECALL = NODECALL + 1
+      NODESTEP = NODESTEP + IWORK(11)
+      NODEFE   = NODEFE + IWORK(12)
+      NODEJE   = NODEJE + IWORK(13)
+      IF (ISTATE .LT. 0) NODEFAIL = NODEFAIL + 1
+
       RETURN
       END
 
@@ -0,0 +1,261 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// times the CHEMKIN/transport kernels on a synthetic box of states,
+// away from the AMR driver, MPI and I/O.  needs chem.bin and tran.bin
+// in the run directory, like ebamrReactive.
+
+#include <cstdio>
+#include <iostream>
+
+#include "ParmParse.H"
+#include "parstream.H"
+#include "Box.H"
+#include "BoxIterator.H"
+#include "FArrayBox.H"
+#include "SPMD.H"
+#include "Misc.H"
+
+#include "EBLGIntegrator.H"
+#include "EBPatchReactiveF_F.H"
+#include "ReactiveBenchmark.H"
+
+using std::endl;
+
+/***************/
+//one line per kernel to pout and (optionally) to the results file
+void reportKernel(FILE*              a_out,
+                  const std::string& a_tag,
+                  const char*        a_kernel,
+                  const Real&        a_seconds,
+                  const long long&   a_cellCalls)
+{
+  Real nsPerCell = 1.0e9*a_seconds/Real(a_cellCalls);
+  pout() << a_kernel << ": " << nsPerCell << " ns/cell ("
+         << a_cellCalls << " cell calls, " << a_seconds << " s)" << endl;
+  if (a_out != NULL)
+    {
+      fprintf(a_out, "%s,%s,%lld,%.6e,%.6e\n", a_tag.c_str(), a_kernel,
+              a_cellCalls, a_seconds, nsPerCell);
+    }
+}
+/***************/
+int
+main(int a_argc, char* a_argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&a_argc,&a_argv);
+#endif
+  { //scoping trick
+
+  char* inFile = NULL;
+  if (a_argc > 1)
+    {
+      inFile = a_argv[1];
+    }
+  ParmParse pp(a_argc-2,a_argv+2,NULL,inFile);
+  ParmParse ppbench("chembench");
+
+  //size of the synthetic box and how often every kernel sweeps it
+  std::vector<int> ncell(SpaceDim, 16);
+  ppbench.queryarr("n_cell", ncell, 0, SpaceDim);
+  int numReps = 10;
+  ppbench.query("num_reps", numReps);
+  Real dt = 1.0e-7;
+  ppbench.query("dt", dt);
+
+  //range of thermochemical states swept across the box
+  Real tempMin = 300.0, tempMax = 2500.0;
+  Real densMin = 0.1,   densMax = 2.0;
+  ppbench.query("temp_min", tempMin);
+  ppbench.query("temp_max", tempMax);
+  ppbench.query("dens_min", densMin);
+  ppbench.query("dens_max", densMax);
+
+  std::string tag("none");
+  ppbench.query("tag", tag);
+
+  FORT_INITIALIZE_CHEMISTRY();
+  int nSpec;
+  FORT_GET_NSPECIES(CHF_INT(nSpec));
+
+  std::vector<Real> massFrac(nSpec, 1.0/Real(nSpec));
+  if (pp.contains("initialMassFrac"))
+    {
+      pp.getarr("initialMassFrac", massFrac, 0, nSpec);
+    }
+
+  IntVect hiEnd;
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      hiEnd[idir] = ncell[idir] - 1;
+    }
+  Box box(IntVect::Zero, hiEnd);
+  long long numCells = box.numPts();
+  long long cellCalls = numCells*numReps;
+
+  pout() << "chemistry kernels: " << nSpec << " species, box " << box
+         << ", " << numReps << " sweeps" << endl;
+
+  //temperature ramps along x, density along y
+  FArrayBox primInit(box, QNUM+nSpec);
+  primInit.setVal(0.0);
+  for (BoxIterator bit(box); bit.ok(); ++bit)
+    {
+      const IntVect& iv = bit();
+      Real fracT = Real(iv[0])/Real(Max(ncell[0]-1, 1));
+      Real fracD = Real(iv[1])/Real(Max(ncell[1]-1, 1));
+      primInit(iv, QRHO)  = densMin + fracD*(densMax - densMin);
+      primInit(iv, QTEMP) = tempMin + fracT*(tempMax - tempMin);
+      for (int ispec = 0; ispec < nSpec; ispec++)
+        {
+          primInit(iv, QSPEC1+ispec) = massFrac[ispec];
+        }
+    }
+
+  //make the conserved state and a consistent primitive state from it
+  int logflag = 0;
+  int verbose = 0;
+  FArrayBox cons(box, CNUM+nSpec);
+  FArrayBox prim(box, QNUM+nSpec);
+  FORT_PRM2CONS(CHF_BOX(box),
+                CHF_FRA(cons),
+                CHF_CONST_FRA(primInit));
+  FORT_CONS2PRM(CHF_BOX(box),
+                CHF_CONST_FRA(cons),
+                CHF_FRA(primInit),
+                CHF_CONST_INT(logflag),
+                CHF_CONST_INT(verbose));
+
+  //the transport kernels take their inputs as separate fabs
+  FArrayBox pres(box, 1), temp(box, 1), spFrac(box, nSpec), spDens(box, nSpec);
+  pres.copy(primInit, QPRES, 0, 1);
+  temp.copy(primInit, QTEMP, 0, 1);
+  spFrac.copy(primInit, QSPEC1, 0, nSpec);
+  spDens.copy(cons, CSPEC1, 0, nSpec);
+
+  FILE* out = NULL;
+  if (ppbench.contains("results_file") && (procID() == 0))
+    {
+      std::string fileName;
+      ppbench.get("results_file", fileName);
+      FILE* test = fopen(fileName.c_str(), "r");
+      bool isNew = (test == NULL);
+      if (test != NULL) fclose(test);
+      out = fopen(fileName.c_str(), "a");
+      if ((out != NULL) && isNew)
+        {
+          fprintf(out, "tag,kernel,cell_calls,seconds,ns_per_cell\n");
+        }
+    }
+
+  Real start, seconds;
+
+  //cons2prm (includes the temperature iteration)
+  start = ReactiveBenchmark::wallTime();
+  for (int irep = 0; irep < numReps; irep++)
+    {
+      FORT_CONS2PRM(CHF_BOX(box),
+                    CHF_CONST_FRA(cons),
+                    CHF_FRA(prim),
+                    CHF_CONST_INT(logflag),
+                    CHF_CONST_INT(verbose));
+    }
+  seconds = ReactiveBenchmark::wallTime() - start;
+  reportKernel(out, tag, "cons2prm", seconds, cellCalls);
+
+  //reactivesrc works in place so every sweep starts from the same states
+  int ncalls, nsteps, nrhs, njac, nfail;
+  int ireset = 1;
+  FORT_GETODESTATS(CHF_INT(ncalls), CHF_INT(nsteps), CHF_INT(nrhs),
+                   CHF_INT(njac), CHF_INT(nfail), CHF_CONST_INT(ireset));
+  seconds = 0;
+  for (int irep = 0; irep < numReps; irep++)
+    {
+      prim.copy(primInit);
+      start = ReactiveBenchmark::wallTime();
+      FORT_REACTIVESRC(CHF_BOX(box),
+                       CHF_CONST_REAL(dt),
+                       CHF_FRA(prim));
+      seconds += ReactiveBenchmark::wallTime() - start;
+    }
+  reportKernel(out, tag, "reactivesrc", seconds, cellCalls);
+  FORT_GETODESTATS(CHF_INT(ncalls), CHF_INT(nsteps), CHF_INT(nrhs),
+                   CHF_INT(njac), CHF_INT(nfail), CHF_CONST_INT(ireset));
+  pout() << "  dvode: " << ncalls << " solves, "
+         << Real(nsteps)/Real(Max(ncalls, 1)) << " steps/solve, "
+         << Real(nrhs)/Real(Max(ncalls, 1))   << " rhs evals/solve, "
+         << Real(njac)/Real(Max(ncalls, 1))   << " jacobians/solve, "
+         << nfail << " failures" << endl;
+
+  //species diffusion coefficients, one species at a time as in setDiffusionCoefficients
+  FArrayBox bco(box, 1), rhsco(box, nSpec);
+  start = ReactiveBenchmark::wallTime();
+  for (int irep = 0; irep < numReps; irep++)
+    {
+      for (int ispec = 0; ispec < nSpec; ispec++)
+        {
+          FORT_GETSPECMASSDIFFCOEFF(CHF_FRA1(bco, 0),
+                                    CHF_FRA(rhsco),
+                                    CHF_CONST_FRA1(pres, 0),
+                                    CHF_CONST_FRA1(temp, 0),
+                                    CHF_CONST_FRA(spDens),
+                                    CHF_CONST_INT(ispec),
+                                    CHF_BOX(box));
+        }
+    }
+  seconds = ReactiveBenchmark::wallTime() - start;
+  reportKernel(out, tag, "getspecmassdiffcoeff", seconds, cellCalls);
+
+  FArrayBox eta(box, 1), lambda(box, 1);
+  start = ReactiveBenchmark::wallTime();
+  for (int irep = 0; irep < numReps; irep++)
+    {
+      FORT_GETVISCOSITY(CHF_FRA1(eta, 0),
+                        CHF_FRA1(lambda, 0),
+                        CHF_CONST_FRA1(temp, 0),
+                        CHF_CONST_FRA(spDens),
+                        CHF_BOX(box));
+    }
+  seconds = ReactiveBenchmark::wallTime() - start;
+  reportKernel(out, tag, "getviscosity", seconds, cellCalls);
+
+  FArrayBox kappa(box, 1);
+  start = ReactiveBenchmark::wallTime();
+  for (int irep = 0; irep < numReps; irep++)
+    {
+      FORT_GETCONDUCTIVITY(CHF_FRA1(kappa, 0),
+                           CHF_FRA1(temp, 0),
+                           CHF_FRA(spDens),
+                           CHF_BOX(box));
+    }
+  seconds = ReactiveBenchmark::wallTime() - start;
+  reportKernel(out, tag, "getconductivity", seconds, cellCalls);
+
+  FArrayBox dkMatrix(box, nSpec*nSpec);
+  start = ReactiveBenchmark::wallTime();
+  for (int irep = 0; irep < numReps; irep++)
+    {
+      FORT_FILLDKMATRIX(CHF_BOX(box),
+                        CHF_CONST_FRA(pres),
+                        CHF_CONST_FRA(temp),
+                        CHF_CONST_FRA(spFrac),
+                        CHF_FRA(dkMatrix));
+    }
+  seconds = ReactiveBenchmark::wallTime() - start;
+  reportKernel(out, tag, "filldkmatrix", seconds, cellCalls);
+
+  if (out != NULL) fclose(out);
+  } //end scoping trick
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return 0;
+}
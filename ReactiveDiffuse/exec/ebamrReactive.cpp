@@ -44,6 +44,10 @@
 #include "memtrack.H"
 #include "GodunovGeom.H"
 #include "CH_Attach.H"
+#include "ReactiveBenchmark.H"
+#include "ReactiveDiagnostics.H"
+#include "Scheduler.H"
+#include "SharedMemoryExchange.H"
 
 #include <iostream>
 
@@ -279,6 +283,37 @@ void amrReactive(const Box&      a_domain,
   amr.blockFactor(block_factor);
   amr.fillRatio(fill_ratio);
 
+  // give neighbouring boxes to ranks of the same node (or socket)
+  bool topologyLoadBalance = false;
+  ppgodunov.query("topology_load_balance", topologyLoadBalance);
+  if (topologyLoadBalance)
+    {
+      Vector<int> rankNodes;
+      if (ppgodunov.contains("rank_nodes"))
+        {
+          ppgodunov.getarr("rank_nodes", rankNodes, 0, numProc());
+        }
+      else
+        {
+          int ranksPerSocket = 0;
+          ppgodunov.query("ranks_per_socket", ranksPerSocket);
+          int numGroups = detectRankNodes(rankNodes, ranksPerSocket);
+          if (verbosity >= 1)
+            {
+              pout() << "topology_load_balance: " << numGroups << " node/socket groups" << endl;
+            }
+        }
+      setRankNodes(rankNodes);
+    }
+
+  // pack on-node ghost and copy data into node-shared segments of this many MB per rank
+  int sharedExchangeMB = 0;
+  ppgodunov.query("shared_memory_exchange_mb", sharedExchangeMB);
+  if (sharedExchangeMB > 0)
+    {
+      SharedMemoryExchange::define(size_t(sharedExchangeMB) << 20);
+    }
+
   // the hyperbolic codes use a grid buffer of 1
   int gridBufferSize;
   ppgodunov.get("grid_buffer_size",gridBufferSize);
@@ -315,6 +350,24 @@ void amrReactive(const Box&      a_domain,
       amr.checkpointPrefix(prefix);
     }
 
+  // one write per level and processor for plot and checkpoint files,
+  // optionally gathered onto num_writers aggregator ranks
+  bool aggregatedWrite = false;
+  ppgodunov.query("aggregated_write", aggregatedWrite);
+  HDF5Handle::setAggregatedWrite(aggregatedWrite);
+  int numWriters = 0;
+  ppgodunov.query("num_writers", numWriters);
+  HDF5Handle::setNumWriters(numWriters);
+
+  // chunked, deflate-compressed datasets (lossless, checkpoints stay exact)
+  int deflateLevel = 0;
+  bool shuffle = true;
+  int chunkSize = 65536;
+  ppgodunov.query("hdf5_deflate_level", deflateLevel);
+  ppgodunov.query("hdf5_shuffle", shuffle);
+  ppgodunov.query("hdf5_chunk_size", chunkSize);
+  HDF5Handle::setCompression(deflateLevel, shuffle, chunkSize);
+
   amr.verbosity(verbosity);
 
   if (!ppgodunov.contains("restart_file"))
@@ -358,12 +411,40 @@ void amrReactive(const Box&      a_domain,
 #endif
     }
 
+  // in-situ reductions and slices every diagnostics_interval coarse steps
+  int diagnosticsInterval = 0;
+  ppgodunov.query("diagnostics_interval", diagnosticsInterval);
+  if (diagnosticsInterval > 0)
+    {
+      RefCountedPtr<ReactiveDiagnostics> diagnostics(new ReactiveDiagnostics());
+      if (diagnostics->isActive())
+        {
+          RefCountedPtr<Scheduler> scheduler(new Scheduler());
+          scheduler->schedule(RefCountedPtr<Scheduler::PeriodicFunction>(diagnostics),
+                              diagnosticsInterval);
+          amr.schedule(scheduler);
+        }
+    }
+
   // run
+  Real runStart = ReactiveBenchmark::wallTime();
   amr.run(stopTime,nstop);
 
   // output last pltfile and statistics
   //cleanup
   amr.conclude();
+  Real runTime = ReactiveBenchmark::wallTime() - runStart;
+
+  // append per-phase throughput when running one of the benchmark cases
+  if (ppgodunov.contains("benchmark_file"))
+    {
+      std::string benchFile, benchCase("ramp"), benchTag("none");
+      ppgodunov.get("benchmark_file", benchFile);
+      ppgodunov.query("benchmark_case", benchCase);
+      ppgodunov.query("benchmark_tag", benchTag);
+      ReactiveBenchmark::write(benchFile, benchCase, benchTag, runTime);
+    }
 
+  SharedMemoryExchange::clear();
 }
 
@@ -9,6 +9,7 @@
 #endif
 
 #include <cmath>
+#include <map>
 
 #include "parstream.H"
 #include "ParmParse.H"
@@ -24,9 +25,11 @@
 #include "CH_HDF5.H"
 #include "SPMD.H"
 #include "LoadBalance.H"
+#include "BRMeshRefine.H"
 #include "ProblemDomain.H"
 #include "BoxIterator.H"
 #include "EBAMRIO.H"
+#include "AMRIO.H"
 #include "AMRLevel.H"
 #include "EBCellFactory.H"
 #include "BaseIVFactory.H"
@@ -41,6 +44,7 @@
 #include "FabDataOps.H"
 #include "EBAMRDataOps.H"
 #include "EBAMRReactive.H"
+#include "ReactiveBenchmark.H"
 #include "EBPatchReactiveF_F.H"
 #include "EBAMRReactiveF_F.H"
 #include "DirichletPoissonEBBC.H"
@@ -76,7 +80,20 @@ RefCountedPtr<MomentumBackwardEuler>          EBAMRReactive::s_viscLevBE;
 RefCountedPtr<EBLevelBackwardEuler>           EBAMRReactive::s_condLevBE;  
 
 BiCGStabSolver<LevelData<EBCellFAB> >        EBAMRReactive::s_botSolver;
+Vector<RefCountedPtr<EBAgglomeratedSolver> > EBAMRReactive::s_aggBotSolver;
 bool EBAMRReactive::s_noEBCF = false;
+bool EBAMRReactive::s_useFastFR = false;
+bool EBAMRReactive::s_timeBoxes = false;
+int  EBAMRReactive::s_timerExportInterval = 0;
+std::string EBAMRReactive::s_timerExportFormat("json");
+bool EBAMRReactive::s_separateGeometry = false;
+bool EBAMRReactive::s_geometryChanged = true;
+std::string EBAMRReactive::s_geometryFile;
+bool EBAMRReactive::s_plotFloat = false;
+bool EBAMRReactive::s_plotCoveredBoxes = true;
+bool EBAMRReactive::s_trackHeatRelease = false;
+bool EBAMRReactive::s_sfcLoadBalance = false;
+int  EBAMRReactive::s_sfcIrregularWeight = 0;
 bool EBAMRReactive::s_solversDefined = false;
 
 
@@ -219,6 +236,7 @@ EBAMRReactive::EBAMRReactive()
   m_isDefined = false;
   m_addReactionRates = false;
   m_addDiffusion = false;
+  m_heatRelease = 0;
 }
 /***************************/
 void EBAMRReactive::redistRadius(int a_redistRad)
@@ -252,6 +270,7 @@ void EBAMRReactive::clearSolvers()
   s_condOpFact = RefCountedPtr<AMRLevelOpFactory<LevelData<EBCellFAB> > >();
   s_condAMRMG = RefCountedPtr<AMRMultiGrid<LevelData<EBCellFAB> > >();
   s_condLevBE = RefCountedPtr<EBLevelBackwardEuler>();
+  s_aggBotSolver.resize(0);
 }
 /***************************/
 void EBAMRReactive::define(AMRLevel*  a_coarser_level_ptr,
@@ -368,14 +387,7 @@ void EBAMRReactive::initialGrid(const Vector<Box>& a_new_grids)
 
   // load balance and create boxlayout
   Vector<int> proc_map;
-  if (s_isLoadBalanceSet)
-    {
-      s_loadBalance(proc_map,a_new_grids, m_domainBox, false);
-    }
-  else
-    {
-      LoadBalance(proc_map,a_new_grids);
-    }
+  loadBalance(proc_map, a_new_grids);
   if (s_verbosity >= 3)
     {
       pout() << " just loadbalanced " << m_level << endl;
@@ -480,6 +492,19 @@ EBAMRReactive::levelSetup()
   m_hasCoarser = (coarPtr != NULL);
   m_hasFiner   = (finePtr != NULL);
 
+  //fused per-box flux register increments for the hyperbolic fluxes
+  ParmParse pp;
+  pp.query("use_fast_fr", s_useFastFR);
+  //per-box cost accounting (load balancing and the boxCost plot variable)
+  pp.query("time_boxes", s_timeBoxes);
+  pp.query("timer_export_interval", s_timerExportInterval);
+  pp.query("timer_export_format", s_timerExportFormat);
+  //geometry in its own file, written with the first plot file after a regrid
+  pp.query("separate_geometry", s_separateGeometry);
+  pp.query("plot_float", s_plotFloat);
+  pp.query("plot_covered_boxes", s_plotCoveredBoxes);
+  s_geometryChanged = true;
+
   //define redistribution object for this level
   //for now set to volume weighting
   m_ebLevelRedist.define(m_eblg.getDBL(),
@@ -523,7 +548,9 @@ EBAMRReactive::levelSetup()
                               m_hasSourceTerm,
                               m_ebPatchReactiveFactory,
                               m_hasCoarser,
-                              m_hasFiner);
+                              m_hasFiner,
+                              s_useFastFR,
+                              s_timeBoxes);
 
       //define fine to coarse redistribution object
       //for now set to volume weighting
@@ -547,6 +574,16 @@ EBAMRReactive::levelSetup()
                             nRefCrse, nvarQuad,
                             (*m_eblg.getCFIVS()),
                             Chombo_EBIS::instance()));
+
+      m_quadCFISpec = RefCountedPtr<EBQuadCFInterp>
+        (new EBQuadCFInterp(m_eblg.getDBL(),
+                            coEBLG.getDBL(),
+                            m_eblg.getEBISL(),
+                            coEBLG.getEBISL(),
+                            coEBLG.getDomain(),
+                            nRefCrse, m_nSpec,
+                            (*m_eblg.getCFIVS()),
+                            Chombo_EBIS::instance()));
                            
 
       coarPtr->syncWithFineLevel();
@@ -554,6 +591,7 @@ EBAMRReactive::levelSetup()
   else
     {
       m_quadCFI = RefCountedPtr<EBQuadCFInterp>(new EBQuadCFInterp());
+      m_quadCFISpec = RefCountedPtr<EBQuadCFInterp>(new EBQuadCFInterp());
       m_ebLevelReactive.define(m_eblg.getDBL(),
                               DisjointBoxLayout(),
                               m_eblg.getEBISL(),
@@ -567,7 +605,9 @@ EBAMRReactive::levelSetup()
                               m_hasSourceTerm,
                               m_ebPatchReactiveFactory,
                               m_hasCoarser,
-                              m_hasFiner);
+                              m_hasFiner,
+                              s_useFastFR,
+                              s_timeBoxes);
     }
   //set up mass redistribution array
   m_sets.define(m_grids);
@@ -664,6 +704,13 @@ defineSolvers()
 
   EBConductivityOp::setForceNoEBCF(s_noEBCF);
   EBViscousTensorOp::setForceNoEBCF(s_noEBCF);
+
+  //single precision coefficients in the smoothers; has to be set before the factories make operators
+  bool singleRelax = false;
+  ParmParse ppmg("amrmultigrid");
+  ppmg.query("single_precision_relax", singleRelax);
+  EBConductivityOp::setSinglePrecisionRelax(singleRelax);
+  EBViscousTensorOp::setSinglePrecisionRelax(singleRelax);
  
   s_diffuseOpFact.resize(m_nSpec);
   
@@ -708,6 +755,45 @@ defineSolvers()
          pp.get("bottom_cushion", bottomCushion);
        }
 
+      //bottom solvers: m_nSpec species, then viscous, then conduction
+      Vector<LinearSolver<LevelData<EBCellFAB> >*> botSolver(m_nSpec+2, &s_botSolver);
+      bool agglomerateBottom = false;
+      pp.query("agglomerate_bottom", agglomerateBottom);
+      s_aggBotSolver.resize(0);
+      if (agglomerateBottom)
+       {
+         int stencilRadius = 2;
+         pp.query("bottom_stencil_radius", stencilRadius);
+         s_aggBotSolver.resize(m_nSpec+2);
+         for (int isolve = 0; isolve < s_aggBotSolver.size(); isolve++)
+          {
+            s_aggBotSolver[isolve] = RefCountedPtr<EBAgglomeratedSolver>(new EBAgglomeratedSolver());
+            s_aggBotSolver[isolve]->setStencilRadius(stencilRadius);
+            s_aggBotSolver[isolve]->setFallback(&s_botSolver);
+            s_aggBotSolver[isolve]->m_verbosity = mgverb;
+            botSolver[isolve] = &(*s_aggBotSolver[isolve]);
+          }
+       }
+
+      //outer iteration: plain V-cycles, or BiCGStab/GMRES preconditioned by one V-cycle
+      int krylovMethod = AMRMultiGrid<LevelData<EBCellFAB> >::noKrylov;
+      std::string krylov("none");
+      pp.query("krylov", krylov);
+      if (krylov == "bicgstab")
+       {
+         krylovMethod = AMRMultiGrid<LevelData<EBCellFAB> >::bicgstabKrylov;
+       }
+      else if (krylov == "gmres")
+       {
+         krylovMethod = AMRMultiGrid<LevelData<EBCellFAB> >::gmresKrylov;
+       }
+      else if (krylov != "none")
+       {
+         MayDay::Error("EBAMRReactive: amrmultigrid.krylov must be none, bicgstab or gmres");
+       }
+      int krylovRestart = 10;
+      pp.query("krylov_restart", krylovRestart);
+
       s_diffuseAMRMG.resize(m_nSpec);
       s_diffuseLevBE.resize(m_nSpec);
 
@@ -716,10 +802,11 @@ defineSolvers()
        {
          // multigrid solver
          s_diffuseAMRMG[iSpec] = RefCountedPtr<AMRMultiGrid<LevelData<EBCellFAB> > >(new AMRMultiGrid<LevelData<EBCellFAB> >());
-         s_diffuseAMRMG[iSpec]->define(lev0Dom, *s_diffuseOpFact[iSpec], &s_botSolver, nlevels);
+         s_diffuseAMRMG[iSpec]->define(lev0Dom, *s_diffuseOpFact[iSpec], botSolver[iSpec], nlevels);
          s_diffuseAMRMG[iSpec]->setSolverParameters(numSmooth, numSmooth, numSmooth, numMG, maxIter, tolerance, hang, normThresh);
          s_diffuseAMRMG[iSpec]->m_verbosity = mgverb;
          s_diffuseAMRMG[iSpec]->m_bottomSolverEpsCushion = bottomCushion;
+         s_diffuseAMRMG[iSpec]->setKrylovMethod(krylovMethod, krylovRestart);
 
          // BE Integrator
          s_diffuseLevBE[iSpec] = RefCountedPtr<EBLevelBackwardEuler>(new EBLevelBackwardEuler(grids, refRat, lev0Dom, s_diffuseOpFact[iSpec], s_diffuseAMRMG[iSpec]));
@@ -728,20 +815,22 @@ defineSolvers()
 
       // viscous stuff
       s_viscAMRMG = RefCountedPtr<AMRMultiGrid< LevelData<EBCellFAB> > >( new AMRMultiGrid< LevelData<EBCellFAB> > ());
-      s_viscAMRMG->define(lev0Dom, *s_viscOpFact, &s_botSolver, nlevels);
+      s_viscAMRMG->define(lev0Dom, *s_viscOpFact, botSolver[m_nSpec], nlevels);
       s_viscAMRMG->setSolverParameters(numSmooth, numSmooth, numSmooth, numMG, maxIter, tolerance, hang, normThresh);
       s_viscAMRMG->m_verbosity = mgverb;
       s_viscAMRMG->m_bottomSolverEpsCushion = bottomCushion;
+      s_viscAMRMG->setKrylovMethod(krylovMethod, krylovRestart);
       
       s_viscLevBE = RefCountedPtr<MomentumBackwardEuler>(new MomentumBackwardEuler(grids, refRat, lev0Dom, s_viscOpFact, s_viscAMRMG));
       s_viscLevBE->setEBLG(eblgs);
 
       // conductivity stuff
       s_condAMRMG = RefCountedPtr<AMRMultiGrid< LevelData<EBCellFAB> > >( new AMRMultiGrid< LevelData<EBCellFAB> > ());
-      s_condAMRMG->define(lev0Dom, *s_condOpFact, &s_botSolver, nlevels);
+      s_condAMRMG->define(lev0Dom, *s_condOpFact, botSolver[m_nSpec+1], nlevels);
       s_condAMRMG->setSolverParameters(numSmooth, numSmooth, numSmooth, numMG, maxIter, tolerance, hang, normThresh);
       s_condAMRMG->m_verbosity = mgverb;
       s_condAMRMG->m_bottomSolverEpsCushion = bottomCushion;
+      s_condAMRMG->setKrylovMethod(krylovMethod, krylovRestart);
        
       s_condLevBE = RefCountedPtr<EBLevelBackwardEuler>(new EBLevelBackwardEuler(grids, refRat, lev0Dom, s_condOpFact, s_condAMRMG));
       s_condLevBE->setEBLG(eblgs);
@@ -1001,7 +1090,9 @@ setDiffusionCoefficients(const LevelData<EBCellFAB>& a_presCell,
                          const LevelData<EBFluxFAB>& a_specDensFace)
 {
   CH_TIME("EBAMRReactive::setDiffusionCoefficients");
-  for (DataIterator dit = m_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
+  TimedDataIterator dit = m_eblg.getDBL().timedDataIterator();
+  if (s_timeBoxes) dit.enableTime();
+  for (dit.begin(); dit.ok(); ++dit)
    {
      Box cellBox = m_eblg.getDBL().get(dit());
      for (int idir = 0; idir < SpaceDim; idir++)
@@ -1113,6 +1204,7 @@ setDiffusionCoefficients(const LevelData<EBCellFAB>& a_presCell,
                                   CHF_CONST_VR(specDense));
       } // end vofit  
    } // end dit
+  if (s_timeBoxes) m_ebLevelReactive.addBoxCost(dit);
 }
 /***************************/
 void EBAMRReactive::tagCellsInit(IntVectSet& a_tags)
@@ -1543,6 +1635,7 @@ Real EBAMRReactive::computeInitialDt()
 void EBAMRReactive::regrid(const Vector<Box>& a_new_grids)
 {
   CH_TIME("EBAMRReactive::regrid");
+  Real regridStart = ReactiveBenchmark::wallTime();
   if (s_verbosity >= 3)
     {
       pout() << " in EBAMRReactive regrid for level " << m_level << endl;
@@ -1575,15 +1668,7 @@ void EBAMRReactive::regrid(const Vector<Box>& a_new_grids)
   //four ghost cells.
   m_level_grids = a_new_grids;
   Vector<int> proc_map;
-
-  if (s_isLoadBalanceSet)
-    {
-      s_loadBalance(proc_map,a_new_grids, m_domainBox, false);
-    }
-  else
-    {
-      LoadBalance(proc_map,a_new_grids);
-    }
+  loadBalance(proc_map, a_new_grids);
 
   m_grids= DisjointBoxLayout(a_new_grids,proc_map);
   m_eblg.define(m_grids, m_problem_domain, 6, ebisPtr);
@@ -1609,11 +1694,15 @@ void EBAMRReactive::regrid(const Vector<Box>& a_new_grids)
 
   // copy from old state
   stateSaved.copyTo(interv,m_stateNew, interv);
+
+  ReactiveBenchmark::add(ReactiveBenchmark::Regrid,
+                         ReactiveBenchmark::wallTime() - regridStart, numLocalCells());
 }
 /***************************/
 Real EBAMRReactive::advance()
 {
   // advance the conservative state by one time step
+  CH_TIMER_LEVEL(m_level);
   CH_TIME("EBAMRReactive::advance");
   EBPatchReactive::s_whichLev = m_level;
   EBViscousTensorOp::s_step = AMR::s_step;
@@ -1714,6 +1803,7 @@ Real EBAMRReactive::advance()
     }
   else
    {
+     ReactivePhaseTimer phaseTimer(ReactiveBenchmark::Hyperbolic, numLocalCells());
      m_ebLevelReactive.divergeF(divergeF,
                                 m_massDiff,
                                 *fineFR,
@@ -1751,15 +1841,24 @@ Real EBAMRReactive::advance()
 
       //step 2) update species mass densities and add them to UStar
       pout() << "step 2: updating species multicomponent diffusion" << endl;
-      addMCSpecDiff(UStar); 
+      {
+        ReactivePhaseTimer phaseTimer(ReactiveBenchmark::MCDiffusion, numLocalCells());
+        addMCSpecDiff(UStar); 
+      }
 
       //step 3) update momentum with viscous terms
       pout() << "step 3: updating momentum with viscocity" << endl;
-      addViscosity(UStar);
+      {
+        ReactivePhaseTimer phaseTimer(ReactiveBenchmark::Viscosity, numLocalCells());
+        addViscosity(UStar);
+      }
 
       //step 4) update energy with conductive terms
       pout() << "step 4: updating energy with conductivity " << endl;
-      addConductivity(UStar);
+      {
+        ReactivePhaseTimer phaseTimer(ReactiveBenchmark::Conductivity, numLocalCells());
+        addConductivity(UStar);
+      }
  
       pout() << "step 5: putting state into m_statenew and flooring" << endl;
       finalAdvance(UStar);
@@ -1784,9 +1883,39 @@ Real EBAMRReactive::advance()
      pout() << "step 6: integrating reaction source terms" << endl;
      // computations are not done on ghost cells. Ghost cells are later filled in posTimeStep
      {
+       ReactivePhaseTimer phaseTimer(ReactiveBenchmark::Chemistry, numLocalCells());
+       LevelData<EBCellFAB> energyOld;
+       if (s_trackHeatRelease)
+         {
+           EBCellFactory fact(m_ebisl);
+           energyOld.define(m_grids, 1, IntVect::Zero, fact);
+           m_stateNew.copyTo(Interval(CENG, CENG), energyOld, Interval(0, 0));
+         }
        m_ebLevelReactive.integrateReactiveSource(m_stateNew,m_domainBox,m_time,new_dt);
+       if (s_trackHeatRelease)
+         {
+           //the temperature is frozen over the chemistry step, so the
+           //energy the state loses is the chemical energy released
+           m_heatRelease = 0;
+           IntVectSet fineCover = finerCoverage();
+           for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+             {
+               const EBISBox& ebisBox = m_ebisl[dit()];
+               IntVectSet ivs(m_grids.get(dit()));
+               ivs -= fineCover;
+               for (VoFIterator vofit(ivs, ebisBox.getEBGraph()); vofit.ok(); ++vofit)
+                 {
+                   const VolIndex& vof = vofit();
+                   Real released = energyOld[dit()](vof, 0) - m_stateNew[dit()](vof, CENG);
+                   m_heatRelease += released*cellVolume(vof, ebisBox);
+                 }
+             }
+           m_heatRelease /= new_dt;
+         }
      }
    } 
+  ReactiveBenchmark::addStep(numLocalCells());
+  CH_TIMER_LEVEL(-1);
   return new_dt; 
 }
 /***************************/ 
@@ -1797,18 +1926,13 @@ getUStar(LevelData<EBCellFAB>      & a_UStar,
 {
   CH_TIME("EBAMRReactive::getUStar");
 
-  EBCellFactory fact(m_eblg.getEBISL());
-  //advance everything explicitly
+  //advance everything explicitly.  ghost cells keep U^n, the flux
+  //divergence only goes into the valid cells
   for (DataIterator dit = m_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
     {
-      EBCellFAB  dtLcU(m_eblg.getEBISL()[dit()], m_eblg.getDBL().get(dit()), m_nComp);
-      dtLcU.setVal(0.);
-      dtLcU += a_divergeF[dit()];
-      dtLcU *= m_dt;
-
-      a_UStar[dit()].setVal(0.);
-      a_UStar[dit()] += a_UN[dit()];
-      a_UStar[dit()] -= dtLcU;
+      const Box& region = m_eblg.getDBL().get(dit());
+      a_UStar[dit()].copy(a_UN[dit()]);
+      a_UStar[dit()].plus(a_divergeF[dit()], region, 0, 0, m_nComp, -m_dt);
     }
 
   m_ebLevelReactive.floorConserved(a_UStar, m_time, m_dt);
@@ -1822,11 +1946,8 @@ explicitAdvance(const LevelData<EBCellFAB>& a_divergeF)
   //advance everything explicitly
   for (DataIterator dit = m_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
     {
-      EBCellFAB dtDivergeF(m_eblg.getEBISL()[dit()], m_eblg.getDBL().get(dit()), a_divergeF.nComp());
-      dtDivergeF.setVal(0.);
-      dtDivergeF += a_divergeF[dit()];
-      dtDivergeF *= m_dt;
-      m_stateNew[dit()] -= dtDivergeF;
+      const Box& region = m_eblg.getDBL().get(dit());
+      m_stateNew[dit()].plus(a_divergeF[dit()], region, 0, 0, a_divergeF.nComp(), -m_dt);
     }
   hyperbolicRedistribution(m_stateNew);
 
@@ -1998,7 +2119,9 @@ addMCSpecDiff(LevelData<EBCellFAB>&       a_UStar)
   Real tCoarOld = 0.0; 
   Real tCoarNew = 0.0;
 
-  //species by species
+  //species by species.  kappaSpecMassDiffSrc batches only the exchange
+  //and coarse-fine interpolation of its explicit apply (applyOpMultiComp);
+  //each species keeps its own multigrid solver and implicit solve here
   for (int iSpec = 0; iSpec < m_nSpec; iSpec++)
    {
      LevelData<EBCellFAB> specMFold(m_eblg.getDBL(), 1, nghost*IntVect::Unit, fact);
@@ -2077,15 +2200,11 @@ addMCSpecDiff(LevelData<EBCellFAB>&       a_UStar)
        } 
     }        
 
-  EBLevelDataOps::scale(MFold, -1./m_dt);
-  EBLevelDataOps::scale(MFnew,  1./m_dt);
   LevelData<EBCellFAB> divMF(m_eblg.getDBL(), m_nSpec, nghost*IntVect::Unit, fact);
   for(DataIterator dit = m_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
     {
-      divMF[dit()].setVal(0.);
       //sets divMF = (MFnew - MFold)/dt
-      divMF[dit()] += MFnew[dit()];
-      divMF[dit()] += MFold[dit()]; //see scale above
+      divMF[dit()].axby(MFnew[dit()], MFold[dit()], 1./m_dt, -1./m_dt);
       //sets divMF = rho(MFnew - MFold)/dt
       for (int iSpec = 0; iSpec < m_nSpec; iSpec++)
        {
@@ -2094,13 +2213,9 @@ addMCSpecDiff(LevelData<EBCellFAB>&       a_UStar)
        }
 
       //now add dt*divMF into ustar
-      EBCellFAB dtDivMF(m_eblg.getEBISL()[dit()], m_eblg.getDBL().get(dit()), m_nSpec);
-      dtDivMF.setVal(0.);
-      dtDivMF += divMF[dit()];
-      dtDivMF *= m_dt;
-
+      const Box& region = m_eblg.getDBL().get(dit());
       int isrc = 0; int idst = CSPEC1; int inco = m_nSpec;
-      a_UStar[dit()].plus(dtDivMF, isrc, idst, inco);
+      a_UStar[dit()].plus(divMF[dit()], region, isrc, idst, inco, m_dt);
     }
 
   if (m_hasCoarser)
@@ -2476,59 +2591,67 @@ kappaSpecMassDiffSrc(LevelData<EBCellFAB>& a_kappaSpecMassSrc,
       }
     }
 
-  //species by species
-  for (int iSpec = 0; iSpec < m_nSpec; iSpec++)
+  Real alpha = 0; Real beta = 1; // want just the div(flux) part of the operator
+  // Compute the mass diffusion term.  coefficient is unity because we want the straight operator
+  // All the species go through one multi-component apply: one exchange and
+  // one coarse-fine interpolation for all of them, each with its own coefficients.
+  int nghost = 4;
+  EBCellFactory fact(m_eblg.getEBISL());
+  Interval specInt(0, m_nSpec-1);
+  LevelData<EBCellFAB> kappaSpecSrc(m_eblg.getDBL(), m_nSpec, nghost*IntVect::Unit, fact);
+  LevelData<EBCellFAB> massFrac(m_eblg.getDBL(), m_nSpec, nghost*IntVect::Unit, fact);
+  LevelData<EBCellFAB>* massFracCoar = NULL;
+  a_specMF.copyTo(specInt, massFrac, specInt);
+
+  if(m_hasCoarser)
    {
-     Real alpha = 0; Real beta = 1; // want just the div(flux) part of the operator
-     // Compute the mass diffusion term.  coefficient is unity because we want the straight operator
-     int nghost = 4;
-     EBCellFactory fact(m_eblg.getEBISL());
-     LevelData<EBCellFAB> kappaSpecSrc(m_eblg.getDBL(),  1, nghost*IntVect::Unit, fact);
-     LevelData<EBCellFAB> massFrac(m_eblg.getDBL(), 1, nghost*IntVect::Unit, fact);
-     LevelData<EBCellFAB>* massFracCoar = NULL;
-     Interval specInt(iSpec, iSpec);
-     Interval thisInt(0, 0);
-     a_specMF.copyTo(specInt, massFrac, thisInt);
+     massFracCoar = new LevelData<EBCellFAB>(m_eblg.getDBL(), m_nSpec, nghost*IntVect::Unit, fact);
+     a_specMFCoar->copyTo(specInt, *massFracCoar, specInt);
+   }
 
-     if(m_hasCoarser)
+  Vector<EBConductivityOp*> specOps(m_nSpec);
+  for (int iSpec = 0; iSpec < m_nSpec; iSpec++)
+   {
+     specOps[iSpec] = dynamic_cast<EBConductivityOp*>(s_diffuseAMRMG[iSpec]->getAMROperators()[m_level]);
+     if (specOps[iSpec] == NULL)
       {
-        massFracCoar = new LevelData<EBCellFAB>(m_eblg.getDBL(),  1, nghost*IntVect::Unit, fact);
-        a_specMFCoar->copyTo(specInt, *massFracCoar, thisInt);
+        MayDay::Error("kappaSpecMassDiffSrc: species operator is not an EBConductivityOp");
       }
+     specOps[iSpec]->setAlphaAndBeta(alpha, beta);
+   }
+  bool homogeneousCFBC = ((massFracCoar == NULL) || (m_level == 0));
+  EBConductivityOp::applyOpMultiComp(kappaSpecSrc, massFrac, massFracCoar, specOps,
+                                     m_quadCFISpec, false, homogeneousCFBC);
 
-     bool applyBC = true;
-     bool explicitHyperbolicSrc = true;  
-     s_diffuseLevBE[iSpec]->applyOperator(kappaSpecSrc,
-                                          massFrac,
-                                          massFracCoar,
-                                          m_level, alpha, beta,applyBC);
+  if (m_hasCoarser)
+   {
+     delete massFracCoar;
+   }
 
-     bool addMCDiff = true;  //MCDiff for MultiComponent Diffusion
+  bool addMCDiff = true;  //MCDiff for MultiComponent Diffusion
 
-     ParmParse pp;
-     if (pp.contains("addMCDiffTerm"))
-      {
-        pp.get("addMCDiffTerm", addMCDiff);
-      }
+  ParmParse pp;
+  if (pp.contains("addMCDiffTerm"))
+   {
+     pp.get("addMCDiffTerm", addMCDiff);
+   }
 
-     if (addMCDiff)
+  if (addMCDiff)
+   {
+     bool applyBC = true;
+     bool explicitHyperbolicSrc = true;
+     LevelData<EBCellFAB> MCDiffTerm(m_eblg.getDBL(), 1, nghost*IntVect::Unit, fact);
+     for (int iSpec = 0; iSpec < m_nSpec; iSpec++)
       {
-        bool explicitHyperbolicSrc = true;
-        LevelData<EBCellFAB> MCDiffTerm(m_eblg.getDBL(), 1, nghost*IntVect::Unit, fact);
         getMCDiffTerm(MCDiffTerm, a_specMF, a_specMFCoar, alpha, beta, iSpec, explicitHyperbolicSrc, applyBC);
         for (DataIterator dit = m_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
          {
-           kappaSpecSrc[dit()] += MCDiffTerm[dit()]; 
+           kappaSpecSrc[dit()].plus(MCDiffTerm[dit()], 0, iSpec, 1);
          }
       }
+   }
 
-     if (m_hasCoarser)
-      {
-        delete massFracCoar;
-      }
- 
-     kappaSpecSrc.copyTo(thisInt, a_kappaSpecMassSrc, specInt);
-   } // end iSpec
+  kappaSpecSrc.copyTo(specInt, a_kappaSpecMassSrc, specInt);
 }
 /***************************/
 void EBAMRReactive::
@@ -2834,113 +2957,644 @@ EBAMRReactive::sumConserved(Real& a_sumcons,
   a_sumcons = sumallgrid;
 }
 /***************************/
-void EBAMRReactive::postTimeStep()
+void EBAMRReactive::diagnosticVariables(Vector<int>&    a_vars,
+                                        Vector<string>& a_names,
+                                        const char*     a_key) const
 {
-  CH_TIME("EBAMRReactive::postTimeStep");
-  if (s_verbosity >= 3)
+  a_vars.resize(0);
+  a_names.resize(0);
+  ParmParse pp;
+  if (!pp.contains(a_key))
     {
-      pout() << " in EBAMRReactive postTimeStep for level " << m_level << endl;
+      return;
     }
-
-  // Average the finer grid level to be consistent with this one
-
-  if (m_hasFiner)
+  int nCons = m_stateNames.size();
+  int nvars = pp.countval(a_key);
+  Vector<string> vars;
+  pp.getarr(a_key, vars, 0, nvars);
+  for (int ivar = 0; ivar < nvars; ivar++)
     {
-      Interval interv(0, m_nComp-1);
-      EBAMRReactive* finePtr = getFinerLevel();
-      finePtr->m_ebCoarseAverage.average(m_stateNew,
-                                         finePtr->m_stateNew,
-                                         interv);
+      //the species names have spaces in them
+      if (vars[ivar] == "species")
+        {
+          for (int ispec = 0; ispec < m_nSpec; ispec++)
+            {
+              a_vars.push_back(CSPEC1 + ispec);
+              a_names.push_back(m_stateNames[CSPEC1 + ispec]);
+            }
+          continue;
+        }
+      int index = -1;
+      for (int i = 0; i < nCons; i++)
+        {
+          if (m_stateNames[i] == vars[ivar])
+            {
+              index = i;
+            }
+        }
+      for (int i = 0; (index < 0) && (i < m_primNames.size()); i++)
+        {
+          if (m_primNames[i] == vars[ivar])
+            {
+              index = nCons + i;
+            }
+        }
+      if (index < 0)
+        {
+          pout() << a_key << ": no variable " << vars[ivar] << endl;
+          MayDay::Error("EBAMRReactive: bad diagnostic variable");
+        }
+      a_vars.push_back(index);
+      a_names.push_back(vars[ivar]);
+    }
+}
+/***************************/
+IntVectSet EBAMRReactive::finerCoverage() const
+{
+  IntVectSet fineCover;
+  const EBAMRReactive* finer = getFinerLevel();
+  if (finer != NULL)
+    {
+      for (LayoutIterator lit = finer->m_grids.layoutIterator(); lit.ok(); ++lit)
+        {
+          fineCover |= coarsen(finer->m_grids[lit()], m_ref_ratio);
+        }
+    }
+  return fineCover;
+}
+/***************************/
+Real EBAMRReactive::cellVolume(const VolIndex& a_vof,
+                               const EBISBox&  a_ebisBox) const
+{
+  if (m_doRZCoords)
+    {
+      Real cellVol, kvol;
+      EBArith::getKVolRZ(kvol, cellVol, a_ebisBox, m_dx[0], a_vof);
+      return cellVol*kvol;
+    }
+  return a_ebisBox.volFrac(a_vof)*D_TERM(m_dx[0], *m_dx[1], *m_dx[2]);
+}
+/***************************/
+void EBAMRReactive::fillVariables(EBCellFAB&         a_data,
+                                  const Vector<int>& a_vars,
+                                  const DataIndex&   a_dit,
+                                  const Box&         a_region) const
+{
+  int nCons = m_ebPatchReactive->numConserved();
+  int nPrim = m_ebPatchReactive->numPrimitives();
+  const EBISBox& ebisBox = m_ebisl[a_dit];
+  const EBCellFAB& consFAB = m_stateNew[a_dit];
+  bool needPrim = false;
+  for (int i = 0; i < a_vars.size(); i++)
+    {
+      needPrim = needPrim || (a_vars[i] >= nCons);
+    }
+  EBCellFAB primFAB;
+  if (needPrim)
+    {
+      //physical values whatever logflag says, they get summed
+      primFAB.define(ebisBox, a_region, nPrim);
+      Real faket = 1.0;
+      IntVectSet emptyivs;
+      int logflag = 0;
+      m_ebPatchReactive->setValidBox(m_grids.get(a_dit), ebisBox, emptyivs, faket, faket);
+      m_ebPatchReactive->consToPrim(primFAB, consFAB, a_region, logflag);
     }
 
-  // this does the refluxing and redistribution evil dance
-  postTimeStepRefluxRedistDance();
-  m_ebLevelReactive.floorConserved(m_stateNew, m_time, m_dt);
-
-  for(DataIterator dit = m_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
+  a_data.define(ebisBox, a_region, a_vars.size());
+  for (int i = 0; i < a_vars.size(); i++)
     {
-      m_massDiff[dit()].setVal(0.0);
-      m_redisRHS[dit()].setVal(0.0);
-    } 
+      int ivar = a_vars[i];
+      if (ivar < nCons)
+        {
+          a_data.copy(a_region, Interval(i, i), a_region, consFAB, Interval(ivar, ivar));
+        }
+      else
+        {
+          a_data.copy(a_region, Interval(i, i), a_region, primFAB, Interval(ivar-nCons, ivar-nCons));
+        }
+    }
 }
-/****************************/
-void EBAMRReactive::
-postTimeStepRefluxRedistDance()
+/***************************/
+void EBAMRReactive::localReductions(Vector<Real>&      a_integral,
+                                    Vector<Real>&      a_max,
+                                    Vector<Real>&      a_min,
+                                    Real&              a_front,
+                                    const Vector<int>& a_vars,
+                                    int                a_frontVar,
+                                    Real               a_frontValue,
+                                    int                a_frontDir) const
 {
-  CH_TIME("EBAMRReactive::evilRedistDance");
-  resetWeights();
-  refluxRedistInteraction();
-  coarseFineRedistribution(Interval(0,m_nComp-1));
-  explicitReflux(Interval(0, m_nComp-1));
-  ParmParse pp;
-  bool turn_off_reflux = false;
-  pp.query("turn_off_implicit_reflux", turn_off_reflux);
-  if (turn_off_reflux)
+  CH_TIME("EBAMRReactive::localReductions");
+  //the front variable rides along as the last one
+  Vector<int> vars = a_vars;
+  int nVars = a_vars.size();
+  if (a_frontVar >= 0)
     {
-      pout() << "implicit reflux turned off" << endl;
+      vars.push_back(a_frontVar);
     }
-  if (addDiffusion() && !turn_off_reflux)
+  IntVectSet fineCover = finerCoverage();
+  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
     {
-      refluxRHSConserved();
-      // defineSolvers();
-      implicitReflux();
+      const Box& grid = m_grids.get(dit());
+      const EBISBox& ebisBox = m_ebisl[dit()];
+      IntVectSet ivs(grid);
+      ivs -= fineCover;
+      if (ivs.isEmpty())
+        {
+          continue;
+        }
+      EBCellFAB data;
+      fillVariables(data, vars, dit(), grid);
+      for (VoFIterator vofit(ivs, ebisBox.getEBGraph()); vofit.ok(); ++vofit)
+        {
+          const VolIndex& vof = vofit();
+          Real volume = cellVolume(vof, ebisBox);
+          for (int i = 0; i < nVars; i++)
+            {
+              Real value = data(vof, i);
+              a_integral[i] += value*volume;
+              a_max[i] = Max(a_max[i], value);
+              a_min[i] = Min(a_min[i], value);
+            }
+          if ((a_frontVar >= 0) && (data(vof, nVars) > a_frontValue))
+            {
+              Real x = m_origin[a_frontDir] + (Real(vof.gridIndex()[a_frontDir]) + 0.5)*m_dx[a_frontDir];
+              a_front = Max(a_front, x);
+            }
+        }
     }
 }
-/****************************/
-void EBAMRReactive::
-implicitReflux()
+/***************************/
+void EBAMRReactive::compositeReductions(Vector<Real>&      a_integral,
+                                        Vector<Real>&      a_max,
+                                        Vector<Real>&      a_min,
+                                        Real&              a_front,
+                                        Real&              a_heatRelease,
+                                        const Vector<int>& a_vars,
+                                        int                a_frontVar,
+                                        Real               a_frontValue,
+                                        int                a_frontDir) const
 {
-  CH_TIME("EBAMRReactive::implicitReflux");
-  pout() << "EBAMRReactive::implicit redist/reflux for level" << m_level << endl;
-  Real crseTime = -1.0;
-  Real timeEps = 1.0e-2*m_dt;
-  if (m_level > 0) crseTime = m_coarser_level_ptr->time();
-
-  if (m_level == 0 || (abs(crseTime - m_time) < timeEps))
+  CH_TIME("EBAMRReactive::compositeReductions");
+  CH_assert(m_level == 0);
+  int nVars = a_vars.size();
+  a_integral.resize(nVars);
+  a_max.resize(nVars);
+  a_min.resize(nVars);
+  a_integral.assign(0.);
+  a_max.assign(-1.0e30);
+  a_min.assign( 1.0e30);
+  a_front = -1.0e30;
+  a_heatRelease = 0;
+
+  //levels above the finest one have no grids
+  for (const EBAMRReactive* lev = this; lev != NULL; lev = lev->getFinerLevel())
     {
-      int finestLev = getFinestLevel();
-      //if I have not caught up to the next coarser level,
-      //then I need to do implicit{reflux,redist} for my level and all
-      //finer levels
-      Vector<AMRLevel*> hierarchy = AMRLevel::getAMRLevelHierarchy();
-      Vector<LevelData<EBCellFAB>* >    deltaVelocity(finestLev+1, NULL);
-      Vector<LevelData<EBCellFAB>* >    deltaTemperat(finestLev+1, NULL);
-      Vector<LevelData<EBCellFAB>* > dtRefluxDivergeM(finestLev+1, NULL);
-      Vector<LevelData<EBCellFAB>* > dtRefluxDivergeE(finestLev+1, NULL);
-   
-      // species stuff
-      Vector<LevelData<EBCellFAB>* >  deltaMassFrac(finestLev+1, NULL);
-      Vector<LevelData<EBCellFAB>* >  dtRefluxDivergeRHO(finestLev+1, NULL);
- 
-      for (int ilev = 0; ilev <= finestLev; ilev++)
+      if (lev->m_grids.size() == 0)
         {
-          EBAMRReactive* reactiveLevel = dynamic_cast<EBAMRReactive*>(hierarchy[ilev]);
+          break;
+        }
+      lev->localReductions(a_integral, a_max, a_min, a_front,
+                           a_vars, a_frontVar, a_frontValue, a_frontDir);
+      a_heatRelease += lev->m_heatRelease;
+    }
 
-          EBCellFactory fact(reactiveLevel->m_eblg.getEBISL());
-          deltaVelocity[ilev]      = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(), SpaceDim, 4*IntVect::Unit, fact);
-          deltaTemperat[ilev]      = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(),        1, 4*IntVect::Unit, fact);
-          dtRefluxDivergeE[ilev]   = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(),        1, 4*IntVect::Unit, fact);
-          dtRefluxDivergeM[ilev]   = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(), SpaceDim, 4*IntVect::Unit, fact);
-          deltaMassFrac[ilev]      = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(),  m_nSpec, 4*IntVect::Unit, fact);
-          dtRefluxDivergeRHO[ilev] = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(),  m_nSpec, 4*IntVect::Unit, fact);
+#ifdef CH_MPI
+  //integrals and the heat release in one reduction
+  Vector<Real> sums = a_integral;
+  sums.push_back(a_heatRelease);
+  Vector<Real> globalSums(nVars+1);
+  MPI_Allreduce(&(sums[0]), &(globalSums[0]), nVars+1, MPI_CH_REAL, MPI_SUM, Chombo_MPI::comm);
+  for (int i = 0; i < nVars; i++)
+    {
+      a_integral[i] = globalSums[i];
+    }
+  a_heatRelease = globalSums[nVars];
 
-          //copy redistRHS to reflux divergence holders
-          Interval srcComp, dstComp;
-          srcComp = Interval(CMOMX, CMOMX+SpaceDim-1);
-          dstComp = Interval(0, SpaceDim-1);
-          reactiveLevel->m_redisRHS.copyTo(srcComp, *dtRefluxDivergeM[ilev], dstComp);
-          srcComp = Interval(CENG, CENG);
-          dstComp = Interval(0, 0);
-          reactiveLevel->m_redisRHS.copyTo(srcComp, *dtRefluxDivergeE[ilev], dstComp);
-          srcComp = Interval(CSPEC1, CSPEC1+m_nSpec-1);
-          dstComp = Interval(0, m_nSpec-1);
-          reactiveLevel->m_redisRHS.copyTo(srcComp, *dtRefluxDivergeRHO[ilev], dstComp);
+  //min is the max of the negatives
+  Vector<Real> maxs = a_max;
+  for (int i = 0; i < nVars; i++)
+    {
+      maxs.push_back(-a_min[i]);
+    }
+  maxs.push_back(a_front);
+  Vector<Real> globalMaxs(2*nVars+1);
+  MPI_Allreduce(&(maxs[0]), &(globalMaxs[0]), 2*nVars+1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+  for (int i = 0; i < nVars; i++)
+    {
+      a_max[i] =  globalMaxs[i];
+      a_min[i] = -globalMaxs[nVars+i];
+    }
+  a_front = globalMaxs[2*nVars];
+#endif
+}
+/***************************/
+void EBAMRReactive::extractSlice(LevelData<FArrayBox>& a_slice,
+                                 const Vector<int>&    a_vars,
+                                 int                   a_dir,
+                                 Real                  a_position) const
+{
+  CH_TIME("EBAMRReactive::extractSlice");
+  const Box& domainBox = m_problem_domain.domainBox();
+  int index = int(floor((a_position - m_origin[a_dir])/m_dx[a_dir]));
+  index = Max(domainBox.smallEnd(a_dir), Min(domainBox.bigEnd(a_dir), index));
+  Vector<Box> boxes;
+  Vector<int> procs;
+  for (LayoutIterator lit = m_grids.layoutIterator(); lit.ok(); ++lit)
+    {
+      Box box = m_grids[lit()];
+      if ((index >= box.smallEnd(a_dir)) && (index <= box.bigEnd(a_dir)))
+        {
+          box.setRange(a_dir, index);
+          boxes.push_back(box);
+          procs.push_back(m_grids.procID(lit()));
+        }
+    }
+  //same ranks as the grids, so filling the slice is local
+  DisjointBoxLayout sliceGrids(boxes, procs, m_problem_domain);
+  int nVars = a_vars.size();
+  a_slice.define(sliceGrids, nVars+1, IntVect::Zero);
 
-          EBLevelDataOps::scale(*dtRefluxDivergeM[ilev], reactiveLevel->m_dt);
-          EBLevelDataOps::scale(*dtRefluxDivergeE[ilev], reactiveLevel->m_dt);
-          EBLevelDataOps::scale(*dtRefluxDivergeRHO[ilev], reactiveLevel->m_dt);
+  //setting the range can reorder the boxes, so look up the grid of each slice box
+  for (DataIterator sit = sliceGrids.dataIterator(); sit.ok(); ++sit)
+    {
+      const Box& sliceBox = sliceGrids.get(sit());
+      DataIterator dit = m_grids.dataIterator();
+      while (dit.ok() && !m_grids.get(dit()).contains(sliceBox))
+        {
+          ++dit;
+        }
+      CH_assert(dit.ok());
+      const EBISBox& ebisBox = m_ebisl[dit()];
+      FArrayBox& sliceFAB = a_slice[sit()];
+      sliceFAB.setVal(0.);
 
-          //these MATTER especially with subcycling
+      EBCellFAB data;
+      fillVariables(data, a_vars, dit(), sliceBox);
+      for (BoxIterator bit(sliceBox); bit.ok(); ++bit)
+        {
+          const IntVect& iv = bit();
+          Vector<VolIndex> vofs = ebisBox.getVoFs(iv);
+          Real kappa = 0;
+          for (int ivof = 0; ivof < vofs.size(); ivof++)
+            {
+              Real volFrac = ebisBox.volFrac(vofs[ivof]);
+              kappa += volFrac;
+              for (int i = 0; i < nVars; i++)
+                {
+                  sliceFAB(iv, i) += volFrac*data(vofs[ivof], i);
+                }
+            }
+          if (kappa > 0)
+            {
+              for (int i = 0; i < nVars; i++)
+                {
+                  sliceFAB(iv, i) /= kappa;
+                }
+            }
+          sliceFAB(iv, nVars) = kappa;
+        }
+    }
+}
+/***************************/
+long long EBAMRReactive::numLocalCells() const
+{
+  long long numCells = 0;
+  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+    {
+      numCells += m_grids.get(dit()).numPts();
+    }
+  return numCells;
+}
+/***************************/
+//lexicographic order so maps can be keyed by IntVect
+class CostIntVectLess
+{
+public:
+  bool operator () (const IntVect& a, const IntVect& b) const
+  {
+    return a.lexLT(b);
+  }
+};
+/***************************/
+bool EBAMRReactive::estimateBoxCost(Vector<long long>& a_cost,
+                                    const Vector<Box>& a_boxes) const
+{
+  CH_TIME("EBAMRReactive::estimateBoxCost");
+  if (!m_ebLevelReactive.isDefined()) return false;
+
+  //the cost of a box was only recorded on the rank that owns it
+  const Vector<unsigned long long>& localCost = m_ebLevelReactive.boxCost();
+  int numOld = localCost.size();
+  if (numOld == 0) return false;
+  TimedDataIterator tdit = m_grids.timedDataIterator();
+  tdit.clearTime();
+  tdit.getTime() = localCost;
+  tdit.mergeTime();
+  const Vector<unsigned long long>& oldCost = tdit.getTime();
+
+  Vector<Box> oldBoxes = m_grids.boxArray();
+  CH_assert(oldBoxes.size() == numOld);
+  Real totalCost  = 0;
+  Real totalCells = 0;
+  Vector<Real> costPerCell(numOld);
+  for (int iold = 0; iold < numOld; iold++)
+    {
+      costPerCell[iold] = Real(oldCost[iold])/Real(oldBoxes[iold].numPts());
+      totalCost  += Real(oldCost[iold]);
+      totalCells += Real(oldBoxes[iold].numPts());
+    }
+  if (totalCost <= 0) return false;
+  Real averageCost = totalCost/totalCells;
+
+  //bucket the old boxes by their small end (as SFCLoadBalance does) so
+  //the ones under a new box can be found without looking at all of them
+  int bucketSize = 1;
+  for (int iold = 0; iold < numOld; iold++)
+    {
+      for (int idir = 0; idir < SpaceDim; idir++)
+        {
+          bucketSize = Max(bucketSize, oldBoxes[iold].size(idir));
+        }
+    }
+  std::map<IntVect, Vector<int>, CostIntVectLess> buckets;
+  for (int iold = 0; iold < numOld; iold++)
+    {
+      buckets[coarsen(oldBoxes[iold].smallEnd(), bucketSize)].push_back(iold);
+    }
+
+  a_cost.resize(a_boxes.size());
+  for (int inew = 0; inew < a_boxes.size(); inew++)
+    {
+      const Box& newBox = a_boxes[inew];
+      Real cost = 0;
+      long long coveredCells = 0;
+      Box bucketBox(coarsen(newBox.smallEnd(), bucketSize) - IntVect::Unit,
+                    coarsen(newBox.bigEnd(),   bucketSize));
+      for (BoxIterator bit(bucketBox); bit.ok(); ++bit)
+        {
+          std::map<IntVect, Vector<int>, CostIntVectLess>::const_iterator it = buckets.find(bit());
+          if (it == buckets.end()) continue;
+          const Vector<int>& olds = it->second;
+          for (int i = 0; i < olds.size(); i++)
+            {
+              Box overlap = newBox & oldBoxes[olds[i]];
+              if (!overlap.isEmpty())
+                {
+                  cost += costPerCell[olds[i]]*Real(overlap.numPts());
+                  coveredCells += overlap.numPts();
+                }
+            }
+        }
+      cost += averageCost*Real(newBox.numPts() - coveredCells);
+      a_cost[inew] = Max((long long)cost, 1LL);
+    }
+  return true;
+}
+/***************************/
+void EBAMRReactive::irregularBoxCost(Vector<long long>& a_cost,
+                                     const Vector<Box>& a_boxes,
+                                     int                a_irregWeight) const
+{
+  CH_TIME("EBAMRReactive::irregularBoxCost");
+  //the layout sorts the boxes, so remember where each one came from
+  std::map<Box, int> boxIndex;
+  for (int ibox = 0; ibox < a_boxes.size(); ibox++)
+    {
+      boxIndex[a_boxes[ibox]] = ibox;
+    }
+  Vector<int> procs;
+  LoadBalance(procs, a_boxes);
+  DisjointBoxLayout dbl(a_boxes, procs, m_problem_domain);
+  EBISLayout ebisl;
+  Chombo_EBIS::instance()->fillEBISLayout(ebisl, dbl, m_problem_domain, 0);
+
+  //each rank fills in its own boxes, merged like measured box times
+  TimedDataIterator dit = dbl.timedDataIterator();
+  dit.clearTime();
+  Vector<unsigned long long>& boxCost = dit.getTime();
+  for (dit.begin(); dit.ok(); ++dit)
+    {
+      const Box& box = dbl.get(dit());
+      const EBISBox& ebisBox = ebisl[dit()];
+      long long numIrreg = 0;
+      if (!ebisBox.isAllRegular() && !ebisBox.isAllCovered())
+        {
+          numIrreg = ebisBox.getIrregIVS(box).numPts();
+        }
+      boxCost[dit().intCode()] = box.numPts() + a_irregWeight*numIrreg;
+    }
+  dit.mergeTime();
+
+  Vector<Box> layoutBoxes = dbl.boxArray();
+  a_cost.resize(a_boxes.size());
+  for (int ibox = 0; ibox < layoutBoxes.size(); ibox++)
+    {
+      a_cost[boxIndex[layoutBoxes[ibox]]] = boxCost[ibox];
+    }
+}
+/***************************/
+void EBAMRReactive::loadBalance(Vector<int>&       a_procs,
+                                const Vector<Box>& a_boxes) const
+{
+  CH_TIME("EBAMRReactive::loadBalance");
+  ParmParse pp;
+  pp.query("sfc_load_balance", s_sfcLoadBalance);
+  pp.query("sfc_irregular_weight", s_sfcIrregularWeight);
+
+  Vector<long long> boxCost;
+  if (s_isLoadBalanceSet)
+    {
+      s_loadBalance(a_procs, a_boxes, m_domainBox, false);
+    }
+  else if (s_sfcLoadBalance)
+    {
+      sfcLoadBalance(a_procs, a_boxes);
+    }
+  else if (s_timeBoxes && estimateBoxCost(boxCost, a_boxes))
+    {
+      LoadBalance(a_procs, boxCost, a_boxes);
+    }
+  else
+    {
+      LoadBalance(a_procs, a_boxes);
+    }
+}
+/***************************/
+void EBAMRReactive::sfcLoadBalance(Vector<int>&       a_procs,
+                                   const Vector<Box>& a_boxes) const
+{
+  CH_TIME("EBAMRReactive::sfcLoadBalance");
+  //restarts hand over the boxes in file order
+  Vector<Box> sfcBoxes = a_boxes;
+  mortonOrdering(sfcBoxes);
+
+  //measured cost if there is one, else volume and irregular cells
+  Vector<long long> cost;
+  if (!(s_timeBoxes && estimateBoxCost(cost, sfcBoxes)))
+    {
+      if (s_sfcIrregularWeight > 0)
+        {
+          irregularBoxCost(cost, sfcBoxes, s_sfcIrregularWeight);
+        }
+      else
+        {
+          cost.resize(sfcBoxes.size());
+          for (int ibox = 0; ibox < sfcBoxes.size(); ibox++)
+            {
+              cost[ibox] = sfcBoxes[ibox].numPts();
+            }
+        }
+    }
+
+  //the coarser level already has its new grids
+  Vector<Box> parentBoxes;
+  Vector<int> parentProcs;
+  int refRatio = 1;
+  EBAMRReactive* coarPtr = getCoarserLevel();
+  if (coarPtr != NULL)
+    {
+      const DisjointBoxLayout& coarGrids = coarPtr->m_grids;
+      for (LayoutIterator lit = coarGrids.layoutIterator(); lit.ok(); ++lit)
+        {
+          parentBoxes.push_back(coarGrids[lit()]);
+          parentProcs.push_back(coarGrids.procID(lit()));
+        }
+      refRatio = coarPtr->refRatio();
+    }
+
+  Vector<int> sfcProcs;
+  SFCLoadBalance(sfcProcs, cost, sfcBoxes, parentBoxes, parentProcs, refRatio);
+
+  std::map<Box, int> boxIndex;
+  for (int ibox = 0; ibox < a_boxes.size(); ibox++)
+    {
+      boxIndex[a_boxes[ibox]] = ibox;
+    }
+  a_procs.resize(a_boxes.size());
+  for (int ibox = 0; ibox < sfcBoxes.size(); ibox++)
+    {
+      a_procs[boxIndex[sfcBoxes[ibox]]] = sfcProcs[ibox];
+    }
+}
+/***************************/
+void EBAMRReactive::postTimeStep()
+{
+  CH_TIMER_LEVEL(m_level);
+  CH_TIME("EBAMRReactive::postTimeStep");
+  if (s_verbosity >= 3)
+    {
+      pout() << " in EBAMRReactive postTimeStep for level " << m_level << endl;
+    }
+
+  // Average the finer grid level to be consistent with this one
+
+  if (m_hasFiner)
+    {
+      Interval interv(0, m_nComp-1);
+      EBAMRReactive* finePtr = getFinerLevel();
+      finePtr->m_ebCoarseAverage.average(m_stateNew,
+                                         finePtr->m_stateNew,
+                                         interv);
+    }
+
+  // this does the refluxing and redistribution evil dance
+  postTimeStepRefluxRedistDance();
+  m_ebLevelReactive.floorConserved(m_stateNew, m_time, m_dt);
+
+  for(DataIterator dit = m_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
+    {
+      m_massDiff[dit()].setVal(0.0);
+      m_redisRHS[dit()].setVal(0.0);
+    } 
+  CH_TIMER_LEVEL(-1);
+
+  //the coarsest level finishes the step last
+  if ((m_level == 0) && (s_timerExportInterval > 0) &&
+      ((AMR::s_step+1) % s_timerExportInterval == 0))
+    {
+      CH_TIMER_EXPORT(AMR::s_step+1, s_timerExportFormat.c_str());
+    }
+}
+/****************************/
+void EBAMRReactive::
+postTimeStepRefluxRedistDance()
+{
+  CH_TIME("EBAMRReactive::evilRedistDance");
+  resetWeights();
+  refluxRedistInteraction();
+  coarseFineRedistribution(Interval(0,m_nComp-1));
+  explicitReflux(Interval(0, m_nComp-1));
+  ParmParse pp;
+  bool turn_off_reflux = false;
+  pp.query("turn_off_implicit_reflux", turn_off_reflux);
+  if (turn_off_reflux)
+    {
+      pout() << "implicit reflux turned off" << endl;
+    }
+  if (addDiffusion() && !turn_off_reflux)
+    {
+      refluxRHSConserved();
+      // defineSolvers();
+      implicitReflux();
+    }
+}
+/****************************/
+void EBAMRReactive::
+implicitReflux()
+{
+  CH_TIME("EBAMRReactive::implicitReflux");
+  pout() << "EBAMRReactive::implicit redist/reflux for level" << m_level << endl;
+  Real crseTime = -1.0;
+  Real timeEps = 1.0e-2*m_dt;
+  if (m_level > 0) crseTime = m_coarser_level_ptr->time();
+
+  if (m_level == 0 || (abs(crseTime - m_time) < timeEps))
+    {
+      int finestLev = getFinestLevel();
+      //if I have not caught up to the next coarser level,
+      //then I need to do implicit{reflux,redist} for my level and all
+      //finer levels
+      Vector<AMRLevel*> hierarchy = AMRLevel::getAMRLevelHierarchy();
+      Vector<LevelData<EBCellFAB>* >    deltaVelocity(finestLev+1, NULL);
+      Vector<LevelData<EBCellFAB>* >    deltaTemperat(finestLev+1, NULL);
+      Vector<LevelData<EBCellFAB>* > dtRefluxDivergeM(finestLev+1, NULL);
+      Vector<LevelData<EBCellFAB>* > dtRefluxDivergeE(finestLev+1, NULL);
+   
+      // species stuff
+      Vector<LevelData<EBCellFAB>* >  deltaMassFrac(finestLev+1, NULL);
+      Vector<LevelData<EBCellFAB>* >  dtRefluxDivergeRHO(finestLev+1, NULL);
+ 
+      for (int ilev = 0; ilev <= finestLev; ilev++)
+        {
+          EBAMRReactive* reactiveLevel = dynamic_cast<EBAMRReactive*>(hierarchy[ilev]);
+
+          EBCellFactory fact(reactiveLevel->m_eblg.getEBISL());
+          deltaVelocity[ilev]      = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(), SpaceDim, 4*IntVect::Unit, fact);
+          deltaTemperat[ilev]      = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(),        1, 4*IntVect::Unit, fact);
+          dtRefluxDivergeE[ilev]   = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(),        1, 4*IntVect::Unit, fact);
+          dtRefluxDivergeM[ilev]   = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(), SpaceDim, 4*IntVect::Unit, fact);
+          deltaMassFrac[ilev]      = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(),  m_nSpec, 4*IntVect::Unit, fact);
+          dtRefluxDivergeRHO[ilev] = new LevelData<EBCellFAB>(reactiveLevel->m_eblg.getDBL(),  m_nSpec, 4*IntVect::Unit, fact);
+
+          //copy redistRHS to reflux divergence holders
+          Interval srcComp, dstComp;
+          srcComp = Interval(CMOMX, CMOMX+SpaceDim-1);
+          dstComp = Interval(0, SpaceDim-1);
+          reactiveLevel->m_redisRHS.copyTo(srcComp, *dtRefluxDivergeM[ilev], dstComp);
+          srcComp = Interval(CENG, CENG);
+          dstComp = Interval(0, 0);
+          reactiveLevel->m_redisRHS.copyTo(srcComp, *dtRefluxDivergeE[ilev], dstComp);
+          srcComp = Interval(CSPEC1, CSPEC1+m_nSpec-1);
+          dstComp = Interval(0, m_nSpec-1);
+          reactiveLevel->m_redisRHS.copyTo(srcComp, *dtRefluxDivergeRHO[ilev], dstComp);
+
+          EBLevelDataOps::scale(*dtRefluxDivergeM[ilev], reactiveLevel->m_dt);
+          EBLevelDataOps::scale(*dtRefluxDivergeE[ilev], reactiveLevel->m_dt);
+          EBLevelDataOps::scale(*dtRefluxDivergeRHO[ilev], reactiveLevel->m_dt);
+
+          //these MATTER especially with subcycling
           EBLevelDataOps::setVal(*deltaVelocity[ilev], 0.0);
           EBLevelDataOps::setVal(*deltaTemperat[ilev], 0.0);
           EBLevelDataOps::setVal(*deltaMassFrac[ilev], 0.0); 
@@ -3040,6 +3694,7 @@ getRefluxDeltaMassFrac(Vector<LevelData<EBCellFAB>* >& a_deltaMassFrac,
       }
  
      //solve equation (rho I - dt Ly) delta = dt*Dr(Frho)
+     //one solve per species, as in the diffusion update
      //rhs already multiplied by dt
      //first true = zero phi
      //second true = force homogeneous bcs (solving for delta Y)
@@ -3517,6 +4172,7 @@ void EBAMRReactive::readCheckpointHeader(HDF5Handle& a_handle)
 /***************************/
 void EBAMRReactive::writeCheckpointLevel(HDF5Handle& a_handle) const
 {
+  ReactivePhaseTimer phaseTimer(ReactiveBenchmark::IO, numLocalCells());
   if (s_verbosity >= 3)
     {
       pout() << "EBAMRReactive::writeCheckpointLevel" << endl;
@@ -3617,18 +4273,42 @@ void EBAMRReactive::readCheckpointLevel(HDF5Handle& a_handle)
       MayDay::Error("readCheckpointLevel: file has no grids");
     }
 
-  Vector<int> proc_map;
-  if (s_isLoadBalanceSet)
-    {
-      s_loadBalance(proc_map,vboxGrids, m_domainBox, false);
-    }
-  else
+  //the checkpoint boxes can be split again for a run on more ranks
+  ParmParse pp;
+  bool resplit = false;
+  pp.query("restart_resplit", resplit);
+  Vector<Box> newBoxes = vboxGrids;
+  Vector<int> parent;
+  if (resplit)
     {
-      LoadBalance(proc_map,vboxGrids);
+      int maxGridSize = 32;
+      int blockFactor = 1;
+      pp.query("max_grid_size", maxGridSize);
+      pp.query("block_factor", blockFactor);
+      newBoxes.resize(0);
+      for (int ibox = 0; ibox < vboxGrids.size(); ibox++)
+        {
+          Vector<Box> pieces;
+          domainSplit(vboxGrids[ibox], pieces, maxGridSize, blockFactor);
+          for (int ipiece = 0; ipiece < pieces.size(); ipiece++)
+            {
+              newBoxes.push_back(pieces[ipiece]);
+              parent.push_back(ibox);
+            }
+        }
+      if (s_verbosity >= 1)
+        {
+          pout() << "readCheckpointLevel: level " << m_level << " split "
+                 << vboxGrids.size() << " checkpoint boxes into " << newBoxes.size() << endl;
+        }
     }
+
+  //balanced over the ranks of this run, whatever wrote the checkpoint
+  Vector<int> proc_map;
+  loadBalance(proc_map, newBoxes);
   broadcast(proc_map, uniqueProc(SerialTask::compute));
 
-  m_grids= DisjointBoxLayout(vboxGrids,proc_map);
+  m_grids= DisjointBoxLayout(newBoxes,proc_map);
   //this keeps the order of the AMRLevel m_level_grids
   //consistent with m_grids
   LayoutIterator lit = m_grids.layoutIterator();
@@ -3652,21 +4332,59 @@ void EBAMRReactive::readCheckpointLevel(HDF5Handle& a_handle)
   
   m_eblg.define(m_grids, m_problem_domain, m_nGhost, ebisPtr);
 
-  //  Interval vars(0, m_nComp-1);
-  //the false says to not redefine the data
-  int dataStatusNew = read<EBCellFAB>(a_handle,
+  int dataStatusNew, dataStatusOld;
+  if (!resplit)
+    {
+      //each rank reads its own boxes straight into the state
+      //the false says to not redefine the data
+      dataStatusNew = read<EBCellFAB>(a_handle,
                                       m_stateNew,
                                       "dataNew",
                                       m_grids,
                                       Interval(),
                                       false);
 
-  int dataStatusOld = read<EBCellFAB>(a_handle,
+      dataStatusOld = read<EBCellFAB>(a_handle,
                                       m_stateOld,
                                       "dataOld",
                                       m_grids,
                                       Interval(),
                                       false);
+    }
+  else
+    {
+      //a checkpoint box is read by the rank that got most of it, so
+      //only the pieces that went elsewhere are copied
+      //the pieces of a checkpoint box are contiguous in newBoxes
+      Vector<int> fileProcs(vboxGrids.size(), 0);
+      int ipiece = 0;
+      for (int ibox = 0; ibox < vboxGrids.size(); ibox++)
+        {
+          std::map<int, long long> ownedCells;
+          long long mostCells = -1;
+          for (; (ipiece < newBoxes.size()) && (parent[ipiece] == ibox); ipiece++)
+            {
+              long long& cells = ownedCells[proc_map[ipiece]];
+              cells += newBoxes[ipiece].numPts();
+              if (cells > mostCells)
+                {
+                  mostCells = cells;
+                  fileProcs[ibox] = proc_map[ipiece];
+                }
+            }
+        }
+      DisjointBoxLayout fileGrids(vboxGrids, fileProcs);
+      EBISLayout fileEBISL;
+      ebisPtr->fillEBISLayout(fileEBISL, fileGrids, m_domainBox, 0);
+      EBCellFactory fileFactory(fileEBISL);
+      LevelData<EBCellFAB> fileData(fileGrids, m_nComp, IntVect::Zero, fileFactory);
+      Interval interv(0, m_nComp-1);
+
+      dataStatusNew = read<EBCellFAB>(a_handle, fileData, "dataNew", fileGrids, Interval(), false);
+      fileData.copyTo(interv, m_stateNew, interv);
+      dataStatusOld = read<EBCellFAB>(a_handle, fileData, "dataOld", fileGrids, Interval(), false);
+      fileData.copyTo(interv, m_stateOld, interv);
+    }
 
   if ((dataStatusNew != 0) || (dataStatusOld != 0))
     {
@@ -3707,6 +4425,53 @@ void EBAMRReactive::writePlotHeader(HDF5Handle& a_handle) const
 
 }
 /***************************/
+//names of the geometric plot components, in the order fillGeometry writes them
+static Vector<string> geometryNames()
+{
+  Vector<string> names;
+  names.push_back("fraction-0");
+
+  const char* areaName[6] = {"xAreafractionLo-0", "xAreafractionHi-0",
+                             "yAreafractionLo-0", "yAreafractionHi-0",
+                             "zAreafractionLo-0", "zAreafractionHi-0"};
+  for (int i=0; i < 2*SpaceDim; i++)
+    {
+      names.push_back(areaName[i]);
+    }
+
+  const char* normName[3] = {"xnormal-0", "ynormal-0", "znormal-0"};
+  for (int i=0; i < SpaceDim; i++)
+    {
+      names.push_back(normName[i]);
+    }
+
+  names.push_back("distance-0");
+  CH_assert(names.size() == 3*SpaceDim+2);
+  return names;
+}
+/***************************/
+//plot000010.2d.hdf5 -> plot000010.geometry.2d.hdf5
+static std::string geometryFileName(const HDF5Handle& a_plotHandle)
+{
+  char plotName[1024];
+  H5Fget_name(a_plotHandle.fileID(), plotName, 1024);
+  std::string fileName(plotName);
+
+  char tail[20];
+  sprintf(tail, "%dd.hdf5", SpaceDim);
+  size_t tailLen = strlen(tail);
+  if ((fileName.size() > tailLen) &&
+      (fileName.compare(fileName.size() - tailLen, tailLen, tail) == 0))
+    {
+      fileName.insert(fileName.size() - tailLen, "geometry.");
+    }
+  else
+    {
+      fileName += ".geometry";
+    }
+  return fileName;
+}
+/***************************/
 void EBAMRReactive::writePlotHeaderOld(HDF5Handle& a_handle) const
 {
   if (s_verbosity >= 3)
@@ -3716,61 +4481,44 @@ void EBAMRReactive::writePlotHeaderOld(HDF5Handle& a_handle) const
 
   HDF5HeaderData header;
   // Setup the number of components
-  //have to add in a lot of geometric crap.
+  //have to add in a lot of geometric crap unless it goes into its own file.
   // 3 norms + 6 area fracs + 1 distance + 1 volFrac
   // =  11 extra components
   //forces 3d
   int nCons = m_ebPatchReactive->numConserved();
   int nPrim = m_ebPatchReactive->numPrimitives() ;
   int consAndPrim = nCons + nPrim;
+  int nGeom = s_separateGeometry ? 0 : 3*SpaceDim+2;
+  Vector<int> plotVars;
+  plotVariables(plotVars);
+  int nVars = plotVars.size();
+  CH_assert(nVars <= consAndPrim);
 
-  int indexVolFrac = consAndPrim;
-  int indexAreaFrac = indexVolFrac+1;
-  int indexNormal = indexAreaFrac+ 2*SpaceDim;
-  int indexDist = indexNormal+SpaceDim;
-  int nCompTotal = indexDist+1;
-  CH_assert(nCompTotal == consAndPrim + 3*SpaceDim+2);
+  int indexVolFrac = nVars;
+  //measured cost of the box (clock ticks since the last regrid)
+  int indexBoxCost = indexVolFrac + nGeom;
+  int nCompTotal = s_timeBoxes ? indexBoxCost+1 : indexBoxCost;
 
   Vector<string> names(nCompTotal);
 
-  for (int i = 0; i < nCons; i++)
-    {
-      names[i] = m_stateNames[i];
-    }
-  for (int i = 0; i < nPrim; i++)
+  for (int i = 0; i < nVars; i++)
     {
-      names[nCons + i] = m_primNames[i];
+      int ivar = plotVars[i];
+      names[i] = (ivar < nCons) ? m_stateNames[ivar] : m_primNames[ivar - nCons];
     }
 
-  string volFracName("fraction-0");
-  Vector<string> normName(3);
-  Vector<string> areaName(6);
-  string distName("distance-0");
-
-  normName[0] = "xnormal-0";
-  normName[1] = "ynormal-0";
-  normName[2] = "znormal-0";
-
-  areaName[0] = "xAreafractionLo-0";
-  areaName[1] = "xAreafractionHi-0";
-  areaName[2] = "yAreafractionLo-0";
-  areaName[3] = "yAreafractionHi-0";
-  areaName[4] = "zAreafractionLo-0";
-  areaName[5] = "zAreafractionHi-0";
-
-  names[indexVolFrac] = volFracName;
-
-  for (int i=0; i < 2*SpaceDim; i++)
+  if (!s_separateGeometry)
     {
-      names[indexAreaFrac+i] = areaName[i];
+      Vector<string> geomNames = geometryNames();
+      for (int i=0; i < nGeom; i++)
+        {
+          names[indexVolFrac+i] = geomNames[i];
+        }
     }
-
-  for (int i=0; i < SpaceDim; i++)
+  if (s_timeBoxes)
     {
-      names[indexNormal+i] = normName[i];
+      names[indexBoxCost] = "boxCost";
     }
-
-  names[indexDist] = distName;
  
   //now output this into the hdf5 handle
   header.m_int["num_components"] = nCompTotal;
@@ -3782,6 +4530,21 @@ void EBAMRReactive::writePlotHeaderOld(HDF5Handle& a_handle) const
       header.m_string[compStr] = names[comp];
     }
 
+  if (s_separateGeometry)
+    {
+      //the geometry only changes at regrid
+      if (s_geometryChanged)
+        {
+          s_geometryFile = geometryFileName(a_handle);
+          writeGeometryFile(s_geometryFile);
+          s_geometryChanged = false;
+        }
+      //stored without the directory so plot and geometry files can be moved together
+      size_t slash = s_geometryFile.find_last_of('/');
+      header.m_string["geometry_file"] =
+        (slash == std::string::npos) ? s_geometryFile : s_geometryFile.substr(slash+1);
+    }
+
   // Write the header to the file
   header.writeToFile(a_handle);
 
@@ -3793,6 +4556,7 @@ void EBAMRReactive::writePlotHeaderOld(HDF5Handle& a_handle) const
 /***************************/
 void EBAMRReactive::writePlotLevel(HDF5Handle& a_handle) const
 {
+  ReactivePhaseTimer phaseTimer(ReactiveBenchmark::IO, numLocalCells());
   if (s_NewPlotFile == 0)
     {
       writePlotLevelOld(a_handle);
@@ -3805,6 +4569,113 @@ void EBAMRReactive::writePlotLevel(HDF5Handle& a_handle) const
   writeCellCentered(a_handle, m_level, &m_stateNew);
 }
 /***************************/
+//appends a_start + the index in a_names of each variable listed under
+//a_key, all of them if a_key is not there.  "none" selects nothing.
+static void selectPlotVars(Vector<int>&          a_vars,
+                           const Vector<string>& a_names,
+                           int                   a_start,
+                           const char*           a_key)
+{
+  ParmParse pp;
+  if (!pp.contains(a_key))
+    {
+      for (int i = 0; i < a_names.size(); i++)
+        {
+          a_vars.push_back(a_start + i);
+        }
+      return;
+    }
+  int nvars = pp.countval(a_key);
+  Vector<string> vars;
+  pp.getarr(a_key, vars, 0, nvars);
+  for (int ivar = 0; ivar < nvars; ivar++)
+    {
+      if (vars[ivar] == "none")
+        {
+          continue;
+        }
+      int index = -1;
+      for (int i = 0; i < a_names.size(); i++)
+        {
+          if (a_names[i] == vars[ivar])
+            {
+              index = i;
+            }
+        }
+      if (index < 0)
+        {
+          pout() << a_key << ": no variable " << vars[ivar] << endl;
+          MayDay::Error("EBAMRReactive: bad plot variable");
+        }
+      a_vars.push_back(a_start + index);
+    }
+}
+/***************************/
+void EBAMRReactive::plotVariables(Vector<int>& a_vars) const
+{
+  a_vars.resize(0);
+  selectPlotVars(a_vars, m_stateNames, 0, "plot_cons_vars");
+  //the primitives are the derived fields
+  selectPlotVars(a_vars, m_primNames, m_stateNames.size(), "plot_prim_vars");
+}
+/***************************/
+//round to the nearest multiple of 2*a_bound so the error is at most a_bound.
+//the rounded data compresses well.
+static void quantize(FArrayBox& a_fab, int a_comp, Real a_bound)
+{
+  Real q = 2*a_bound;
+  Real* data = a_fab.dataPtr(a_comp);
+  long npts = a_fab.box().numPts();
+  for (long i = 0; i < npts; i++)
+    {
+      data[i] = q*floor(data[i]/q + 0.5);
+    }
+}
+/***************************/
+void EBAMRReactive::plotErrorBounds(Vector<Real>& a_bounds) const
+{
+  int nCons = m_stateNames.size();
+  int nPrim = m_primNames.size();
+  ParmParse pp;
+  Real defaultBound = 0;
+  pp.query("plot_error_bound", defaultBound);
+  a_bounds.resize(0);
+  a_bounds.resize(nCons + nPrim, defaultBound);
+  if (pp.contains("plot_error_bound_vars"))
+    {
+      int nvars = pp.countval("plot_error_bound_vars");
+      Vector<string> vars;
+      Vector<Real> bounds;
+      pp.getarr("plot_error_bound_vars",   vars,   0, nvars);
+      pp.getarr("plot_error_bound_values", bounds, 0, nvars);
+      for (int ivar = 0; ivar < nvars; ivar++)
+        {
+          bool found = false;
+          for (int i = 0; i < nCons; i++)
+            {
+              if (m_stateNames[i] == vars[ivar])
+                {
+                  a_bounds[i] = bounds[ivar];
+                  found = true;
+                }
+            }
+          for (int i = 0; i < nPrim; i++)
+            {
+              if (m_primNames[i] == vars[ivar])
+                {
+                  a_bounds[nCons + i] = bounds[ivar];
+                  found = true;
+                }
+            }
+          if (!found)
+            {
+              pout() << "plot_error_bound_vars: no plot variable " << vars[ivar] << endl;
+              MayDay::Error("EBAMRReactive: bad plot_error_bound_vars");
+            }
+        }
+    }
+}
+/***************************/
 void EBAMRReactive::writePlotLevelOld(HDF5Handle& a_handle) const
 {
 
@@ -3816,12 +4687,19 @@ void EBAMRReactive::writePlotLevelOld(HDF5Handle& a_handle) const
   int nCons = m_ebPatchReactive->numConserved();
   int nPrim = m_ebPatchReactive->numPrimitives() ;
   int consAndPrim = nCons + nPrim;
-  int indexVolFrac = consAndPrim;
-  int indexAreaFrac = indexVolFrac+1;
-  int indexNormal = indexAreaFrac+ 2*SpaceDim;
-  int indexDist = indexNormal+SpaceDim;
-  int nCompTotal = indexDist+1;
-  CH_assert(nCompTotal == consAndPrim + 3*SpaceDim+2);
+  int nGeom = s_separateGeometry ? 0 : 3*SpaceDim+2;
+  Vector<int> plotVars;
+  plotVariables(plotVars);
+  int nVars = plotVars.size();
+  bool needPrim = false;
+  for (int i = 0; i < nVars; i++)
+    {
+      needPrim = needPrim || (plotVars[i] >= nCons);
+    }
+  int indexVolFrac = nVars;
+  //measured cost of the box (clock ticks since the last regrid)
+  int indexBoxCost = indexVolFrac + nGeom;
+  int nCompTotal = s_timeBoxes ? indexBoxCost+1 : indexBoxCost;
 
   Vector<Real> coveredValuesCons(nCons, -10.0);
   Vector<Real> coveredValuesPrim(nPrim, -10.0);
@@ -3832,6 +4710,11 @@ void EBAMRReactive::writePlotLevelOld(HDF5Handle& a_handle) const
 
   LevelData<FArrayBox> fabData(m_grids, nCompTotal, IntVect::Zero);
 
+  //lossy output of the state, geometry and box cost stay exact
+  Vector<Real> errorBound;
+  plotErrorBounds(errorBound);
+  CH_assert(errorBound.size() == consAndPrim);
+
 #ifdef CH_MPI
     MPI_Barrier(Chombo_MPI::comm);
 #endif
@@ -3850,112 +4733,64 @@ void EBAMRReactive::writePlotLevelOld(HDF5Handle& a_handle) const
         {
           pp.get("logflag", logflag);
         }
-      m_ebPatchReactive->setValidBox(grid, ebisbox, emptyivs, faket, faket);
-      m_ebPatchReactive->consToPrim(primfab, consfab, grid, logflag);
+      if (needPrim)
+        {
+          m_ebPatchReactive->setValidBox(grid, ebisbox, emptyivs, faket, faket);
+          m_ebPatchReactive->consToPrim(primfab, consfab, grid, logflag);
+        }
 
       FArrayBox& currentFab = fabData[dit()];
 
       // copy regular data
-      currentFab.copy(consfab.getSingleValuedFAB(),0,0,nCons);
-      currentFab.copy(primfab.getSingleValuedFAB(),0,nCons,nPrim);
-
-      // set default volume fraction
-      currentFab.setVal(1.0,indexVolFrac);
-
-      // set default area fractions
-      for (int i=0; i < 2*SpaceDim; i++)
+      for (int i = 0; i < nVars; i++)
         {
-          currentFab.setVal(1.0,indexAreaFrac+i);
+          int ivar = plotVars[i];
+          if (ivar < nCons)
+            {
+              currentFab.copy(consfab.getSingleValuedFAB(),ivar,i,1);
+            }
+          else
+            {
+              currentFab.copy(primfab.getSingleValuedFAB(),ivar-nCons,i,1);
+            }
         }
 
-      // set default normal
-      for (int i=0; i < SpaceDim; i++)
+      if (!s_separateGeometry)
         {
-          currentFab.setVal(0.0,indexNormal+i);
+          fillGeometry(currentFab, indexVolFrac, ebisbox, grid);
         }
 
-      // set default distance of EB from corner
-      currentFab.setVal(0.0,indexDist);
-
-      // set special values
-      // iterate through the current grid
-      // NOTE:  this is probably an inefficient way to do this
-      for (BoxIterator bit(grid); bit.ok(); ++bit)
+      // the cost is only known on the owning rank
+      if (s_timeBoxes)
         {
-          const IntVect& iv = bit();
-          // set special values for covered cells
-          if (ebisbox.isCovered(iv))
-            {
-              for (int icomp = 0; icomp < consAndPrim; icomp++)
-                {
-                  Real cval = coveredValues[icomp];
-
-                  currentFab(iv,icomp) = cval;
-                }
-              // volume fraction is zero
-              currentFab(iv,indexVolFrac) = 0.0;
-
-              // area fractions are zero
-              for (int i=0; i < 2*SpaceDim; i++)
-                {
-                  currentFab(iv,indexAreaFrac+i) = 0.0;
-                }
-            }
+          const Vector<unsigned long long>& boxCost = m_ebLevelReactive.boxCost();
+          currentFab.setVal(Real(boxCost[dit().intCode()]), indexBoxCost);
+        }
 
-          // set special values for irregular cells
-          if (ebisbox.isIrregular(iv))
+      // set special values for covered cells
+      if (!ebisbox.isAllRegular())
+        {
+          for (BoxIterator bit(grid); bit.ok(); ++bit)
             {
-              Vector<VolIndex> vofs = ebisbox.getVoFs(iv);
-              Real volFrac = ebisbox.volFrac(vofs[0]);
-              RealVect normal = ebisbox.normal(vofs[0]);
-
-              // set volume fraction
-              currentFab(iv,indexVolFrac) = volFrac;
-
-              // set area fractions--use only the first face you find
-              for (int i=0; i < SpaceDim; i++)
+              const IntVect& iv = bit();
+              if (ebisbox.isCovered(iv))
                 {
-                  Vector<FaceIndex> faces;
-
-                  faces = ebisbox.getFaces(vofs[0],i,Side::Lo);
-                  if (faces.size() == 0)
-                    {
-                      currentFab(iv,indexAreaFrac+2*i) = 0.0;
-                    }
-                  else
+                  for (int icomp = 0; icomp < nVars; icomp++)
                     {
-                      currentFab(iv,indexAreaFrac+2*i) =
-                        ebisbox.areaFrac(faces[0]);
+                      currentFab(iv,icomp) = coveredValues[plotVars[icomp]];
                     }
-
-                  faces = ebisbox.getFaces(vofs[0],i,Side::Hi);
-                  if (faces.size() == 0)
-                    {
-                      currentFab(iv,indexAreaFrac+2*i+1) = 0.0;
-                    }
-                  else
-                    {
-                      currentFab(iv,indexAreaFrac+2*i+1) =
-                        ebisbox.areaFrac(faces[0]);
-                    }
-                }
-
-              // set normal
-              for (int i=0; i < SpaceDim; i++)
-                {
-                  currentFab(iv,indexNormal+i) = normal[i];
                 }
+            }
+        }
 
-              // set distance unless the length of the normal is zero
-              Real length = PolyGeom::dot(normal,normal);
-
-              if (length > 0)
-                {
-                  Real dist = PolyGeom::computeAlpha(volFrac,normal)*m_dx[0];
-                  currentFab(iv,indexDist) = -dist;
-                }
-            } //end if (isIrregular)
-        }//end loop over cells
+      for (int icomp = 0; icomp < nVars; icomp++)
+        {
+          Real bound = errorBound[plotVars[icomp]];
+          if (bound > 0)
+            {
+              quantize(currentFab, icomp, bound);
+            }
+        }
     }//end loop over grids
 
 #ifdef CH_MPI
@@ -3985,9 +4820,274 @@ void EBAMRReactive::writePlotLevelOld(HDF5Handle& a_handle) const
       pout() << header << endl;
     }
 
+  // boxes under the finer level can be left out
+  LevelData<FArrayBox> plotData;
+  const LevelData<FArrayBox>* outData = &fabData;
+  const EBAMRReactive* finer = getFinerLevel();
+  if (!s_plotCoveredBoxes && (finer != NULL) && (finer->m_grids.size() > 0))
+    {
+      IntVectSet fineCover = finerCoverage();
+      Vector<Box> boxes;
+      Vector<int> procs;
+      for (LayoutIterator lit = m_grids.layoutIterator(); lit.ok(); ++lit)
+        {
+          IntVectSet uncovered(m_grids[lit()]);
+          uncovered -= fineCover;
+          if (!uncovered.isEmpty())
+            {
+              boxes.push_back(m_grids[lit()]);
+              procs.push_back(m_grids.procID(lit()));
+            }
+        }
+      //same boxes on the same ranks, so the copy stays local
+      DisjointBoxLayout plotGrids(boxes, procs, m_problem_domain);
+      plotData.define(plotGrids, nCompTotal, IntVect::Zero);
+      fabData.copyTo(plotData);
+      outData = &plotData;
+    }
+
   // Write the data for this level
-  write(a_handle,fabData.boxLayout());
-  write(a_handle,fabData,"data");
+  a_handle.setFloatOutput(s_plotFloat);
+  write(a_handle,outData->boxLayout());
+  write(a_handle,*outData,"data");
+  a_handle.setFloatOutput(false);
+}
+/***************************/
+void EBAMRReactive::fillGeometry(FArrayBox&     a_fab,
+                                 int            a_startComp,
+                                 const EBISBox& a_ebisBox,
+                                 const Box&     a_grid) const
+{
+  int indexVolFrac = a_startComp;
+  int indexAreaFrac = indexVolFrac+1;
+  int indexNormal = indexAreaFrac+ 2*SpaceDim;
+  int indexDist = indexNormal+SpaceDim;
+
+  // set default volume fraction
+  a_fab.setVal(1.0,indexVolFrac);
+
+  // set default area fractions
+  for (int i=0; i < 2*SpaceDim; i++)
+    {
+      a_fab.setVal(1.0,indexAreaFrac+i);
+    }
+
+  // set default normal
+  for (int i=0; i < SpaceDim; i++)
+    {
+      a_fab.setVal(0.0,indexNormal+i);
+    }
+
+  // set default distance of EB from corner
+  a_fab.setVal(0.0,indexDist);
+
+  if (a_ebisBox.isAllRegular())
+    {
+      return;
+    }
+
+  // set special values
+  // iterate through the current grid
+  // NOTE:  this is probably an inefficient way to do this
+  for (BoxIterator bit(a_grid); bit.ok(); ++bit)
+    {
+      const IntVect& iv = bit();
+      // set special values for covered cells
+      if (a_ebisBox.isCovered(iv))
+        {
+          // volume fraction is zero
+          a_fab(iv,indexVolFrac) = 0.0;
+
+          // area fractions are zero
+          for (int i=0; i < 2*SpaceDim; i++)
+            {
+              a_fab(iv,indexAreaFrac+i) = 0.0;
+            }
+        }
+
+      // set special values for irregular cells
+      if (a_ebisBox.isIrregular(iv))
+        {
+          Vector<VolIndex> vofs = a_ebisBox.getVoFs(iv);
+          Real volFrac = a_ebisBox.volFrac(vofs[0]);
+          RealVect normal = a_ebisBox.normal(vofs[0]);
+
+          // set volume fraction
+          a_fab(iv,indexVolFrac) = volFrac;
+
+          // set area fractions--use only the first face you find
+          for (int i=0; i < SpaceDim; i++)
+            {
+              Vector<FaceIndex> faces;
+
+              faces = a_ebisBox.getFaces(vofs[0],i,Side::Lo);
+              if (faces.size() == 0)
+                {
+                  a_fab(iv,indexAreaFrac+2*i) = 0.0;
+                }
+              else
+                {
+                  a_fab(iv,indexAreaFrac+2*i) =
+                    a_ebisBox.areaFrac(faces[0]);
+                }
+
+              faces = a_ebisBox.getFaces(vofs[0],i,Side::Hi);
+              if (faces.size() == 0)
+                {
+                  a_fab(iv,indexAreaFrac+2*i+1) = 0.0;
+                }
+              else
+                {
+                  a_fab(iv,indexAreaFrac+2*i+1) =
+                    a_ebisBox.areaFrac(faces[0]);
+                }
+            }
+
+          // set normal
+          for (int i=0; i < SpaceDim; i++)
+            {
+              a_fab(iv,indexNormal+i) = normal[i];
+            }
+
+          // set distance unless the length of the normal is zero
+          Real length = PolyGeom::dot(normal,normal);
+
+          if (length > 0)
+            {
+              Real dist = PolyGeom::computeAlpha(volFrac,normal)*m_dx[0];
+              a_fab(iv,indexDist) = -dist;
+            }
+        } //end if (isIrregular)
+    }//end loop over cells
+}
+/***************************/
+void EBAMRReactive::writeGeometryFile(const std::string& a_fileName) const
+{
+  CH_TIME("EBAMRReactive::writeGeometryFile");
+  CH_assert(m_level == 0);
+  if (s_verbosity >= 2)
+    {
+      pout() << "geometry file name = " << a_fileName << endl;
+    }
+
+  //levels above the finest one have no grids
+  Vector<const EBAMRReactive*> levels;
+  for (const EBAMRReactive* lev = this; lev != NULL; lev = lev->getFinerLevel())
+    {
+      if (lev->m_grids.size() == 0)
+        {
+          break;
+        }
+      levels.push_back(lev);
+    }
+
+  HDF5Handle handle(a_fileName.c_str(), HDF5Handle::CREATE);
+
+  //same layout as a plot file so it can be opened on its own
+  HDF5HeaderData header;
+  header.m_int ["num_levels"] = levels.size();
+  header.m_int ["iteration"]  = AMR::s_step;
+  header.m_real["time"]       = m_time;
+
+  Vector<string> names = geometryNames();
+  header.m_int["num_components"] = names.size();
+  char compStr[30];
+  for (int comp = 0; comp < names.size(); ++comp)
+    {
+      sprintf(compStr,"component_%d",comp);
+      header.m_string[compStr] = names[comp];
+    }
+  header.writeToFile(handle);
+
+  for (int ilev = 0; ilev < levels.size(); ilev++)
+    {
+      levels[ilev]->writeGeometryLevel(handle);
+    }
+  handle.close();
+}
+/***************************/
+void EBAMRReactive::writeGeometryLevel(HDF5Handle& a_handle) const
+{
+  int nGeom = 3*SpaceDim+2;
+  LevelData<FArrayBox> geomData(m_grids, nGeom, IntVect::Zero);
+  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+    {
+      fillGeometry(geomData[dit()], 0, m_ebisl[dit()], m_grids.get(dit()));
+    }
+
+  char levelStr[20];
+  sprintf(levelStr,"%d",m_level);
+  const std::string label = std::string("level_") + levelStr;
+
+  a_handle.setGroup(label);
+
+  HDF5HeaderData header;
+  header.m_int ["ref_ratio"]   = m_ref_ratio;
+  header.m_real["dx"]          = m_dx[0];
+  header.m_real["time"]        = m_time;
+  header.m_box ["prob_domain"] = m_problem_domain.domainBox();
+  header.writeToFile(a_handle);
+
+  write(a_handle,geomData.boxLayout());
+  write(a_handle,geomData,"data");
+}
+/***************************/
+void EBAMRReactive::writeSliceFile(const std::string& a_fileName,
+                                   const Vector<int>& a_vars,
+                                   int                a_dir,
+                                   Real               a_position) const
+{
+  CH_TIME("EBAMRReactive::writeSliceFile");
+  CH_assert(m_level == 0);
+  CH_assert((a_dir >= 0) && (a_dir < SpaceDim));
+
+  //the plane is nested like the levels, so it stops at the first level that misses it
+  Vector<DisjointBoxLayout> sliceGrids;
+  Vector<LevelData<FArrayBox>* > sliceData;
+  Vector<int> refRatios;
+  for (const EBAMRReactive* lev = this; lev != NULL; lev = lev->getFinerLevel())
+    {
+      if (lev->m_grids.size() == 0)
+        {
+          break;
+        }
+      LevelData<FArrayBox>* slice = new LevelData<FArrayBox>();
+      lev->extractSlice(*slice, a_vars, a_dir, a_position);
+      if (slice->disjointBoxLayout().size() == 0)
+        {
+          delete slice;
+          break;
+        }
+      sliceGrids.push_back(slice->disjointBoxLayout());
+      sliceData.push_back(slice);
+      refRatios.push_back(lev->m_ref_ratio);
+    }
+
+  int nCons = m_stateNames.size();
+  Vector<string> names;
+  for (int i = 0; i < a_vars.size(); i++)
+    {
+      int ivar = a_vars[i];
+      names.push_back((ivar < nCons) ? m_stateNames[ivar] : m_primNames[ivar-nCons]);
+    }
+  names.push_back("fraction-0");
+
+  //a domain one cell thick, so the file reads like any other plot file
+  Box domain = m_problem_domain.domainBox();
+  int index = int(floor((a_position - m_origin[a_dir])/m_dx[a_dir]));
+  index = Max(domain.smallEnd(a_dir), Min(domain.bigEnd(a_dir), index));
+  domain.setRange(a_dir, index);
+
+  if (s_verbosity >= 2)
+    {
+      pout() << "slice file name = " << a_fileName << endl;
+    }
+  WriteAMRHierarchyHDF5(a_fileName, sliceGrids, sliceData, names, domain,
+                        m_dx[0], m_dt, m_time, refRatios, sliceData.size());
+  for (int ilev = 0; ilev < sliceData.size(); ilev++)
+    {
+      delete sliceData[ilev];
+    }
 }
 
 #endif
@@ -13,6 +13,7 @@
 #include "BaseIFFactory.H"
 #include "BaseIFFAB.H"
 #include "EBFluxFAB.H"
+#include "EBFluxFactory.H"
 #include "FaceIterator.H"
 #include "REAL.H"
 #include "EBCellFactory.H"
@@ -30,6 +31,8 @@ int EBLevelReactive::s_timestep = 0;
 EBLevelReactive::EBLevelReactive()
 {
   m_isDefined = false;
+  m_useFastFR = false;
+  m_timeBoxes = false;
   m_ebPatchReactive = NULL;
   m_SFD = false;
   m_isHyperbolicSrcSet = false;
@@ -64,7 +67,9 @@ EBLevelReactive::define(const DisjointBoxLayout&       a_thisDBL,
                         const bool&                    a_hasSourceTerm,
                         const EBPatchReactiveFactory*  const a_patchReactive,
                         const bool&                    a_hasCoarser,
-                        const bool&                    a_hasFiner)
+                        const bool&                    a_hasFiner,
+                        const bool&                    a_useFastFR,
+                        const bool&                    a_timeBoxes)
 {
   CH_TIME("EBLevelReactive::define");
   CH_assert(a_dx[0] > 0.0);
@@ -79,6 +84,11 @@ EBLevelReactive::define(const DisjointBoxLayout&       a_thisDBL,
   m_domain = a_domain;
   m_hasCoarser= a_hasCoarser;
   m_hasFiner= a_hasFiner;
+  m_useFastFR = a_useFastFR;
+  m_timeBoxes = a_timeBoxes;
+  //costs are accumulated from one regrid to the next
+  m_boxCost.resize(0);
+  m_boxCost.resize(m_thisGrids.size(), 0);
   m_doSmushing = a_doSmushing;
   m_doRZCoords = a_doRZCoords;
   m_hasSourceTerm = a_hasSourceTerm;
@@ -148,6 +158,12 @@ EBLevelReactive::define(const DisjointBoxLayout&       a_thisDBL,
     m_ebIrregFaceFlux.define(m_thisGrids, m_nCons,
                              IntVect::Zero, cellFactorySmall);
   }
+  if (m_useFastFR)
+    {
+      CH_TIME("face_flux_defs");
+      EBFluxFactory fluxFactory(m_thisEBISL);
+      m_faceFlux.define(m_thisGrids, m_nFlux, IntVect::Zero, fluxFactory);
+    }
 
   {
     CH_TIME("coarse-fine_ivs_defs");
@@ -178,6 +194,34 @@ EBLevelReactive::define(const DisjointBoxLayout&       a_thisDBL,
       }
   }
 
+  {
+    CH_TIME("patch_context_defs");
+    //the stencils only change with the grids, so build them once here
+    //instead of every time the patch integrator visits a box
+    m_patchContext.define(m_thisGrids);
+    m_updateContext.define(m_thisGrids);
+    const Box& domBox = m_domain.domainBox();
+    for (DataIterator dit = m_thisGrids.dataIterator(); dit.ok(); ++dit)
+      {
+        const Box& cellBox = m_thisGrids.get(dit());
+        const EBISBox& ebisBox = m_thisEBISL[dit()];
+        const IntVectSet& cfivs = m_cfIVS[dit()];
+        m_patchContext[dit()] = RefCountedPtr<EBPatchReactive::PatchContext>(new EBPatchReactive::PatchContext());
+        m_ebPatchReactive->fillContext(*m_patchContext[dit()], cellBox, ebisBox, cfivs);
+
+        const Box b = cellBox & grow(domBox,-2);
+        if (b == cellBox)
+          {
+            m_updateContext[dit()] = m_patchContext[dit()];
+          }
+        else
+          {
+            m_updateContext[dit()] = RefCountedPtr<EBPatchReactive::PatchContext>(new EBPatchReactive::PatchContext());
+            m_ebPatchReactive->fillContext(*m_updateContext[dit()], b, ebisBox, cfivs);
+          }
+      }
+  }
+
   {
     CH_TIME("flattening_defs");
     //create temp data with the correct number of ghost cells
@@ -201,9 +245,7 @@ Real EBLevelReactive::getMaxWaveSpeed(const LevelData<EBCellFAB>& a_state)
         {
           //place holder not used maxWaveSpeed calc
           Real time = 0.0;
-          const IntVectSet& cfivs = m_cfIVS[dit()];
-
-          m_ebPatchReactive->setValidBox(validBox, ebisBox, cfivs, time, time);
+          m_ebPatchReactive->bindContext(*m_patchContext[dit()], time, time, false);
           Real speedOverBox = m_ebPatchReactive->getMaxWaveSpeed(a_state[dit()],
                                                                 validBox);
           speed = Max(speed,speedOverBox);
@@ -314,7 +356,7 @@ computeFlattening(Real a_time, Real a_dt,
         {
           const Box& cellBox = m_thisGrids.get(dit());
           const IntVectSet& cfivs = m_cfIVS[dit()];
-          m_ebPatchReactive->setValidBox(cellBox, ebisBox, cfivs, a_time, a_dt);
+          m_ebPatchReactive->bindContext(*m_patchContext[dit()], a_time, a_dt, false);
           m_ebPatchReactive->setCoveredConsVals(consState);
           int nPrim  = m_ebPatchReactive->numPrimitives();
           EBCellFAB primState(ebisBox, consState.getRegion(), nPrim);
@@ -352,7 +394,9 @@ doRegularUpdate(LevelData<EBCellFAB>&         a_divF,
   int ibox = 0;
   Interval consInterv(0, m_nCons-1);
   Interval fluxInterv(0, m_nFlux-1);
-  for (DataIterator dit = m_thisGrids.dataIterator(); dit.ok(); ++dit, ibox++)
+  TimedDataIterator dit = m_thisGrids.timedDataIterator();
+  if (m_timeBoxes) dit.enableTime();
+  for (dit.begin(); dit.ok(); ++dit, ibox++)
     {
       const Box& cellBox = m_thisGrids.get(dit());
 
@@ -368,11 +412,23 @@ doRegularUpdate(LevelData<EBCellFAB>&         a_divF,
 
           EBCellFAB& consState = a_cons[dit()];
 //          m_ebPatchReactive->setValidBox(cellBox, ebisBox, cfivs, a_time, a_dt);
-          m_ebPatchReactive->setValidBox(b, ebisBox, cfivs, a_time, a_dt); // debug
+          //context of b (debug), the only place the work arrays are needed
+          m_ebPatchReactive->bindContext(*m_updateContext[dit()], a_time, a_dt, true);
 
           const EBCellFAB& source = a_source[dit()];
 
-          EBFluxFAB flux(ebisBox, cellBox, m_nFlux);
+          EBFluxFAB localFlux;
+          EBFluxFAB* fluxPtr = &localFlux;
+          if (m_useFastFR)
+            {
+              //registers get incremented in doIrregularUpdate
+              fluxPtr = &m_faceFlux[dit()];
+            }
+          else
+            {
+              localFlux.define(ebisBox, cellBox, m_nFlux);
+            }
+          EBFluxFAB& flux = *fluxPtr;
           BaseIVFAB<Real>& nonConsDiv    = m_nonConsDivergence[dit()];
           BaseIVFAB<Real>& ebIrregFlux   = m_ebIrregFaceFlux[dit()];
           flux.setVal(78910);
@@ -406,23 +462,26 @@ doRegularUpdate(LevelData<EBCellFAB>&         a_divF,
             To the finer level FR, this level is the coarse level.
             To the coarser level FR, this level is the fine level.
           */
-          for(int idir = 0; idir < SpaceDim; idir++)
+          if (!m_useFastFR)
             {
-              Real scale = a_dt;
-
-              EBFaceFAB fluxRegFlux;
-              if(m_hasFiner)
+              for(int idir = 0; idir < SpaceDim; idir++)
                 {
-                  a_fineFluxRegister.incrementCoarseRegular(flux[idir], scale,dit(),
-                                                            consInterv, idir);
-                }
+                  Real scale = a_dt;
 
-              if(m_hasCoarser)
-                {
-                  for(SideIterator sit; sit.ok(); ++sit)
+                  EBFaceFAB fluxRegFlux;
+                  if(m_hasFiner)
                     {
-                      a_coarFluxRegister.incrementFineRegular(flux[idir],scale, dit(),
-                                                              consInterv, idir,sit());
+                      a_fineFluxRegister.incrementCoarseRegular(flux[idir], scale,dit(),
+                                                                consInterv, idir);
+                    }
+
+                  if(m_hasCoarser)
+                    {
+                      for(SideIterator sit; sit.ok(); ++sit)
+                        {
+                          a_coarFluxRegister.incrementFineRegular(flux[idir],scale, dit(),
+                                                                  consInterv, idir,sit());
+                        }
                     }
                 }
             }
@@ -450,6 +509,7 @@ doRegularUpdate(LevelData<EBCellFAB>&         a_divF,
             }
         }
     }
+  if (m_timeBoxes) addBoxCost(dit);
 
   for(int faceDir = 0; faceDir < SpaceDim; faceDir++)
     {
@@ -470,7 +530,9 @@ doIrregularUpdate(LevelData<EBCellFAB>&         a_divergeF,
   int ibox = 0;
   Interval consInterv(0, m_nCons-1);
   Interval fluxInterv(0, m_nFlux-1);
-  for (DataIterator dit = m_thisGrids.dataIterator(); dit.ok(); ++dit, ibox++)
+  TimedDataIterator dit = m_thisGrids.timedDataIterator();
+  if (m_timeBoxes) dit.enableTime();
+  for (dit.begin(); dit.ok(); ++dit, ibox++)
     {
       const Box& cellBox = m_thisGrids.get(dit());
       const EBISBox& ebisBox = m_thisEBISL[dit()];
@@ -481,7 +543,7 @@ doIrregularUpdate(LevelData<EBCellFAB>&         a_divergeF,
           EBCellFAB& consState = a_cons[dit()];
           BaseIVFAB<Real>& redMass = a_massDiff[dit()];
 
-          m_ebPatchReactive->setValidBox(cellBox, ebisBox, cfivs, a_time, a_dt);
+          m_ebPatchReactive->bindContext(*m_patchContext[dit()], a_time, a_dt, false);
 
           BaseIFFAB<Real> centroidFlux[SpaceDim];
           const BaseIFFAB<Real>* interpolantGrid[SpaceDim];
@@ -513,30 +575,50 @@ doIrregularUpdate(LevelData<EBCellFAB>&         a_divergeF,
             To the finer level FR, this level is the coarse level.
             To the coarser level FR, this level is the fine level.
           */
-          for(int idir = 0; idir < SpaceDim; idir++)
+          if (m_useFastFR)
             {
-              Real scale = a_dt;
-
-              BaseIFFAB<Real> fluxRegFlux;
+              //one pass over all directions, sides and EB/CF vofs
+              //for both the regular and the centroid fluxes
+              const EBFluxFAB& faceFlux = m_faceFlux[dit()];
               if(m_hasFiner)
                 {
-                  a_fineFluxRegister.incrementCoarseIrregular(centroidFlux[idir],
-                                                              scale,dit(),
-                                                              consInterv, idir);
+                  a_fineFluxRegister.incrementCoarseAll(faceFlux, centroidFlux, a_dt,
+                                                        dit(), consInterv);
                 }
-
               if(m_hasCoarser)
                 {
-                  for(SideIterator sit; sit.ok(); ++sit)
+                  a_coarFluxRegister.incrementFineAll(faceFlux, centroidFlux, a_dt,
+                                                      dit(), consInterv);
+                }
+            }
+          else
+            {
+              for(int idir = 0; idir < SpaceDim; idir++)
+                {
+                  Real scale = a_dt;
+
+                  BaseIFFAB<Real> fluxRegFlux;
+                  if(m_hasFiner)
                     {
-                      a_coarFluxRegister.incrementFineIrregular(centroidFlux[idir],
-                                                                scale, dit(),
-                                                                consInterv, idir,sit());
+                      a_fineFluxRegister.incrementCoarseIrregular(centroidFlux[idir],
+                                                                  scale,dit(),
+                                                                  consInterv, idir);
+                    }
+
+                  if(m_hasCoarser)
+                    {
+                      for(SideIterator sit; sit.ok(); ++sit)
+                        {
+                          a_coarFluxRegister.incrementFineIrregular(centroidFlux[idir],
+                                                                    scale, dit(),
+                                                                    consInterv, idir,sit());
+                        }
                     }
                 }
             }
         }
     }// end of loop over grids.
+  if (m_timeBoxes) addBoxCost(dit);
 }
 /*****************************/
 void
@@ -547,10 +629,8 @@ floorConserved(LevelData<EBCellFAB>&         a_consState,
   for (DataIterator dit = m_thisGrids.dataIterator(); dit.ok(); ++dit)
     {
       EBCellFAB& consState = a_consState[dit()];
-      const IntVectSet& cfivs = m_cfIVS[dit()];
-      const EBISBox& ebisBox = m_thisEBISL[dit()];
       const Box& cellBox = m_thisGrids.get(dit());
-      m_ebPatchReactive->setValidBox(cellBox, ebisBox, cfivs, a_time, a_dt);
+      m_ebPatchReactive->bindContext(*m_patchContext[dit()], a_time, a_dt, false);
       m_ebPatchReactive->floorConserved(consState, cellBox);
     }
 }
@@ -570,15 +650,29 @@ integrateReactiveSource(LevelData<EBCellFAB>& a_consState,
                         const Real&           a_time,
                         const Real&           a_dt)
 {
-  for (DataIterator dit = m_thisGrids.dataIterator(); dit.ok(); ++dit)
+  TimedDataIterator dit = m_thisGrids.timedDataIterator();
+  if (m_timeBoxes) dit.enableTime();
+  for (dit.begin(); dit.ok(); ++dit)
     {
       EBCellFAB& consState = a_consState[dit()];
-      const IntVectSet& cfivs = m_cfIVS[dit()];
-      const EBISBox& ebisBox = m_thisEBISL[dit()];
       const Box& cellBox = m_thisGrids.get(dit()) & a_domain; // to exclude ghost cells which are filled later in postTimeStep()
 
-      m_ebPatchReactive->setValidBox(cellBox, ebisBox, cfivs, a_time, a_dt);
+      //only the geometry is needed, the box is passed explicitly
+      m_ebPatchReactive->bindContext(*m_patchContext[dit()], a_time, a_dt, false);
       m_ebPatchReactive->integrateReactiveSource(consState, cellBox, a_dt);
     } 
+  if (m_timeBoxes) addBoxCost(dit);
+}
+/*****************************/
+void
+EBLevelReactive::
+addBoxCost(const TimedDataIterator& a_dit)
+{
+  const Vector<unsigned long long>& boxTime = a_dit.getTime();
+  CH_assert(boxTime.size() == m_boxCost.size());
+  for (int ibox = 0; ibox < boxTime.size(); ibox++)
+    {
+      m_boxCost[ibox] += boxTime[ibox];
+    }
 }
 /*****************************/
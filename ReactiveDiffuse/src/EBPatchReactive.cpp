@@ -55,6 +55,8 @@ EBPatchReactive::EBPatchReactive()
   m_isBoxSet   = false;
   m_useAgg     = false;
   m_bc         = NULL;
+  m_ownContext = new PatchContext();
+  m_context    = m_ownContext;
 }
 
 EBPatchReactive::~EBPatchReactive()
@@ -63,6 +65,7 @@ EBPatchReactive::~EBPatchReactive()
     {
       delete m_bc;
      }
+  delete m_ownContext;
 }
 /******/
 void 
@@ -508,18 +511,39 @@ setValidBox(const Box&        a_validBox,
             const Real&       a_cumulativeTime,
             const Real&       a_timestep)
 {
-  m_isBoxSet = true;
-  m_dt       = a_timestep;
-  m_time     = a_cumulativeTime;
+  fillContext(*m_ownContext, a_validBox, a_ebisBox, a_coarseFineIVS);
+  bindContext(*m_ownContext, a_cumulativeTime, a_timestep, true);
+}
+/******************/
+void
+EBPatchReactive::
+fillContext(PatchContext&     a_context,
+            const Box&        a_validBox,
+            const EBISBox&    a_ebisBox,
+            const IntVectSet& a_coarseFineIVS)
+{
+  CH_TIME("EBPatchReactive::fillContext");
+  m_context  = &a_context;
   m_validBox = a_validBox;
   m_ebisBox  = a_ebisBox;
+  //I know that a lot of these objects are slightly larger than they
+  //need to be.   Be warned, however, that it is
+  //really important that all these things are the same size.
+  //This allows me to make all kinds of wacky stenciling assumptions down
+  //the road.  Mess with these definitions at thy peril.
+  m_validBoxG4  = grow(m_validBox, 4);
+  m_validBoxG4 &= m_domain;
+
+  a_context.m_validBox   = m_validBox;
+  a_context.m_validBoxG4 = m_validBoxG4;
+  a_context.m_ebisBox    = m_ebisBox;
 
   //define the interpolation stencils
   IntVectSet ivsIrreg = m_ebisBox.getIrregIVS(m_validBox);
   FaceStop::WhichFaces facestop = FaceStop::SurroundingWithBoundary;
   for (int idir = 0; idir < SpaceDim; idir++)
     {
-      BaseIFFAB<FaceStencil>& stenDir = m_interpStencils[idir];
+      BaseIFFAB<FaceStencil>& stenDir = a_context.m_interpStencils[idir];
       stenDir.define(ivsIrreg, m_ebisBox.getEBGraph(), idir, 1);
       for (FaceIterator faceit(ivsIrreg, m_ebisBox.getEBGraph(), idir, facestop);
           faceit.ok(); ++faceit)
@@ -529,14 +553,62 @@ setValidBox(const Box&        a_validBox,
                                                        m_ebisBox, m_domain.domainBox());
           stenDir(face, 0) = sten;
         }
+      //flattened against the interpolant on first use
+      a_context.m_interpCompiled[idir] = false;
     }
-  //I know that a lot of these objects are slightly larger than they
-  //need to be.   Be warned, however, that it is
-  //really important that all these things are the same size.
-  //This allows me to make all kinds of wacky stenciling assumptions down
-  //the road.  Mess with these definitions at thy peril.
-  m_validBoxG4  = grow(m_validBox, 4);
-  m_validBoxG4 &= m_domain;
+  compileDivergenceStencil(a_context.m_divFlat, ivsIrreg);
+  a_context.m_divIVS = ivsIrreg;
+
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      IntVectSet irregIVSPlus, irregIVSMinu;
+      computeCoveredFaces(a_context.m_coveredFacePlusG4[idir],
+                          a_context.m_coveredSetsPlusG4[idir],
+                          irregIVSPlus,
+                          idir, Side::Hi, m_validBoxG4);
+      computeCoveredFaces(a_context.m_coveredFaceMinuG4[idir],
+                          a_context.m_coveredSetsMinuG4[idir],
+                          irregIVSMinu,
+                          idir, Side::Lo, m_validBoxG4);
+    }
+
+  //offsets into the primitive state, which is a G4 EBCellFAB
+  //so its multi-valued part lives on these cells
+  IntVectSet ivsMultiG4 = m_ebisBox.getMultiCells(m_validBoxG4 & m_ebisBox.getRegion());
+  BaseIVFAB<Real> multiPrim(ivsMultiG4, m_ebisBox.getEBGraph(), numPrimitives());
+  IntVectSet        ivsIrregG4 =  m_ebisBox.getIrregIVS(m_validBoxG4);
+  VoFIterator vofit(ivsIrregG4,   m_ebisBox.getEBGraph());
+  a_context.m_irregVoFs = vofit.getVector();
+  a_context.m_updateStencil.resize(a_context.m_irregVoFs.size());
+  for (int ivof = 0; ivof<a_context.m_irregVoFs.size(); ivof++)
+    {
+      fillUpdateStencil(a_context.m_updateStencil[ivof], a_context.m_irregVoFs[ivof], multiPrim);
+    }
+
+  if (m_useAgg)
+    setSlopeStuff();
+
+  a_context.m_isFilled = true;
+}
+/******************/
+void
+EBPatchReactive::
+bindContext(PatchContext& a_context,
+            const Real&   a_time,
+            const Real&   a_dt,
+            bool          a_defineWorkArrays)
+{
+  CH_assert(a_context.isFilled());
+  m_isBoxSet   = true;
+  m_dt         = a_dt;
+  m_time       = a_time;
+  m_context    = &a_context;
+  m_validBox   = a_context.m_validBox;
+  m_validBoxG4 = a_context.m_validBoxG4;
+  m_ebisBox    = a_context.m_ebisBox;
+  if (!a_defineWorkArrays) return;
+
+  CH_TIME("EBPatchReactive::defineWorkArrays");
   int numFlux = numFluxes();
   int numPrim = numPrimitives();
   m_primState.define(   m_ebisBox, m_validBoxG4, numPrim);
@@ -549,24 +621,16 @@ setValidBox(const Box&        a_validBox,
       m_primMinu[idir].define(m_ebisBox, m_validBoxG4,       numPrim);
       m_fluxOne [idir].define(m_ebisBox, m_validBoxG4, idir, numFlux);
 
-      IntVectSet irregIVSPlus, irregIVSMinu;
-      computeCoveredFaces(m_coveredFacePlusG4[idir],
-                          m_coveredSetsPlusG4[idir],
-                          irregIVSPlus,
-                          idir, Side::Hi, m_validBoxG4);
-      computeCoveredFaces(m_coveredFaceMinuG4[idir],
-                          m_coveredSetsMinuG4[idir],
-                          irregIVSMinu,
-                          idir, Side::Lo, m_validBoxG4);
-
-      m_extendStatePlusG4  [idir].define(m_coveredSetsPlusG4[idir], m_ebisBox.getEBGraph(), numPrim);
-      m_extendStateMinuG4  [idir].define(m_coveredSetsMinuG4[idir], m_ebisBox.getEBGraph(), numPrim);
-      m_extendStateNormPlus[idir].define(m_coveredSetsPlusG4[idir], m_ebisBox.getEBGraph(), numPrim);
-      m_extendStateNormMinu[idir].define(m_coveredSetsMinuG4[idir], m_ebisBox.getEBGraph(), numPrim);
-      m_coveredFluxPlusG4  [idir].define(m_coveredSetsPlusG4[idir], m_ebisBox.getEBGraph(), numFlux);
-      m_coveredFluxMinuG4  [idir].define(m_coveredSetsMinuG4[idir], m_ebisBox.getEBGraph(), numFlux);
-      m_coveredFluxNormPlus[idir].define(m_coveredSetsPlusG4[idir], m_ebisBox.getEBGraph(), numFlux);
-      m_coveredFluxNormMinu[idir].define(m_coveredSetsMinuG4[idir], m_ebisBox.getEBGraph(), numFlux);
+      const IntVectSet& coveredSetsPlus = a_context.m_coveredSetsPlusG4[idir];
+      const IntVectSet& coveredSetsMinu = a_context.m_coveredSetsMinuG4[idir];
+      m_extendStatePlusG4  [idir].define(coveredSetsPlus, m_ebisBox.getEBGraph(), numPrim);
+      m_extendStateMinuG4  [idir].define(coveredSetsMinu, m_ebisBox.getEBGraph(), numPrim);
+      m_extendStateNormPlus[idir].define(coveredSetsPlus, m_ebisBox.getEBGraph(), numPrim);
+      m_extendStateNormMinu[idir].define(coveredSetsMinu, m_ebisBox.getEBGraph(), numPrim);
+      m_coveredFluxPlusG4  [idir].define(coveredSetsPlus, m_ebisBox.getEBGraph(), numFlux);
+      m_coveredFluxMinuG4  [idir].define(coveredSetsMinu, m_ebisBox.getEBGraph(), numFlux);
+      m_coveredFluxNormPlus[idir].define(coveredSetsPlus, m_ebisBox.getEBGraph(), numFlux);
+      m_coveredFluxNormMinu[idir].define(coveredSetsMinu, m_ebisBox.getEBGraph(), numFlux);
 
       m_extendStatePlusG4[idir].setVal(0.);
       m_extendStateMinuG4[idir].setVal(0.);
@@ -579,10 +643,10 @@ setValidBox(const Box&        a_validBox,
             {
               m_fluxTwo[idir][jdir].define(m_ebisBox, m_validBoxG4, idir, numFlux);
 
-              m_extendStatePlus3D[idir][jdir].define(m_coveredSetsPlusG4[idir], m_ebisBox.getEBGraph(), numPrim);
-              m_extendStateMinu3D[idir][jdir].define(m_coveredSetsMinuG4[idir], m_ebisBox.getEBGraph(), numPrim);
-              m_coveredFluxPlus3D[idir][jdir].define(m_coveredSetsPlusG4[idir], m_ebisBox.getEBGraph(), numFlux);
-              m_coveredFluxMinu3D[idir][jdir].define(m_coveredSetsMinuG4[idir], m_ebisBox.getEBGraph(), numFlux);
+              m_extendStatePlus3D[idir][jdir].define(coveredSetsPlus, m_ebisBox.getEBGraph(), numPrim);
+              m_extendStateMinu3D[idir][jdir].define(coveredSetsMinu, m_ebisBox.getEBGraph(), numPrim);
+              m_coveredFluxPlus3D[idir][jdir].define(coveredSetsPlus, m_ebisBox.getEBGraph(), numFlux);
+              m_coveredFluxMinu3D[idir][jdir].define(coveredSetsMinu, m_ebisBox.getEBGraph(), numFlux);
               m_extendStatePlus3D[idir][jdir].setVal(0.);
               m_extendStateMinu3D[idir][jdir].setVal(0.);
               m_coveredFluxPlus3D[idir][jdir].setVal(0.);
@@ -590,30 +654,20 @@ setValidBox(const Box&        a_validBox,
             }
         }
     }
-  IntVectSet        ivsIrregG4 =  m_ebisBox.getIrregIVS(m_validBoxG4);
-  VoFIterator vofit(ivsIrregG4,   m_ebisBox.getEBGraph());
-  m_irregVoFs = vofit.getVector();
-  m_updateStencil.resize(m_irregVoFs.size());
-  for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
-    {
-      fillUpdateStencil(m_updateStencil[ivof], m_irregVoFs[ivof]);
-    }
-
-  if (m_useAgg)
-    setSlopeStuff();
-
 }
 /******************/
 void
 EBPatchReactive::
-fillUpdateStencil(EBPatchReactive::updateStencil_t& a_stencil, const VolIndex& a_vof)
+fillUpdateStencil(EBPatchReactive::updateStencil_t& a_stencil,
+                  const VolIndex&                   a_vof,
+                  const BaseIVFAB<Real>&            a_multiValued)
 {
   //i am going to use this assumption in many places
   int numVoFs = m_ebisBox.numVoFs(a_vof.gridIndex());
   if (numVoFs > 1)
     {
       a_stencil.m_vofOffset.m_multiValued = true;
-      const BaseIVFAB<Real>& baseivfabPhi= m_primState.getMultiValuedFAB();
+      const BaseIVFAB<Real>& baseivfabPhi= a_multiValued;
       a_stencil.m_vofOffset.m_offset = baseivfabPhi.getIndex(a_vof, 0) - baseivfabPhi.dataPtr(0);
     }
   else
@@ -657,12 +711,12 @@ setSlopeStuff()
 
       if (usesFourthOrderSlopes())
         {
-          eblohicenter(loBox, hasLo, hiBox, hasHi, centerBox, m_entireBox[idir],
+          eblohicenter(loBox, hasLo, hiBox, hasHi, centerBox, m_context->m_entireBox[idir],
                        box2, m_domain, idir);
         }
       else
         {
-          eblohicenter(loBox, hasLo, hiBox, hasHi, centerBox, m_entireBox[idir],
+          eblohicenter(loBox, hasLo, hiBox, hasHi, centerBox, m_context->m_entireBox[idir],
                        box1, m_domain, idir);
         }
     }
@@ -670,15 +724,15 @@ setSlopeStuff()
   for (int idir = 0; idir < SpaceDim; idir++)
     {
       IntVectSet        ivsIrregG4 =  m_ebisBox.getIrregIVS(m_validBoxG4);
-      ivsIrregG4 &= m_entireBox[idir] ;
+      ivsIrregG4 &= m_context->m_entireBox[idir] ;
       VoFIterator vofit(ivsIrregG4,   m_ebisBox.getEBGraph());
       const Vector<VolIndex>& vofs = vofit.getVector();
-      m_slopVec[idir].resize(vofs.size());
+      m_context->m_slopVec[idir].resize(vofs.size());
       Vector<VoFStencil> slowStenLo(vofs.size());
       Vector<VoFStencil> slowStenHi(vofs.size());
       //for getting offsets
       EBCellFAB dumprim(m_ebisBox,      m_validBoxG4, numPrimitives());
-      EBCellFAB dumslop(m_ebisBox, m_entireBox[idir], numSlopes());
+      EBCellFAB dumslop(m_ebisBox, m_context->m_entireBox[idir], numSlopes());
       for (int ivof = 0; ivof < vofs.size(); ivof++)
         {
           const VolIndex& vof = vofs[ivof];
@@ -697,10 +751,10 @@ setSlopeStuff()
           bool hasFacesLo = (facesLo.size()==1) && !onLeftDomain;
           bool hasFacesHi = (facesHi.size()==1) && !onRighDomain;
 
-          m_slopVec[idir][ivof].hasLo = hasFacesLo;
-          m_slopVec[idir][ivof].hasHi = hasFacesHi;
-          m_slopVec[idir][ivof].slop_access.offset = dumslop.offset(  vof, 0);
-          m_slopVec[idir][ivof].slop_access.dataID = dumslop.dataType(vof);
+          m_context->m_slopVec[idir][ivof].hasLo = hasFacesLo;
+          m_context->m_slopVec[idir][ivof].hasHi = hasFacesHi;
+          m_context->m_slopVec[idir][ivof].slop_access.offset = dumslop.offset(  vof, 0);
+          m_context->m_slopVec[idir][ivof].slop_access.dataID = dumslop.dataType(vof);
           if (hasFacesLo)
             {
               slowStenLo[ivof].add(facesLo[0].getVoF(Side::Lo), -1.0);
@@ -723,9 +777,9 @@ setSlopeStuff()
           basestenhi[ivof] = RefCountedPtr<BaseStencil>(new VoFStencil(slowStenHi[ivof]));
         }
 
-      m_slopStenLo[idir] = RefCountedPtr< AggStencil <EBCellFAB, EBCellFAB > >
+      m_context->m_slopStenLo[idir] = RefCountedPtr< AggStencil <EBCellFAB, EBCellFAB > >
         (new AggStencil <EBCellFAB, EBCellFAB >(baseindice, basestenlo, dumprim, dumslop));
-      m_slopStenHi[idir] = RefCountedPtr< AggStencil <EBCellFAB, EBCellFAB > >
+      m_context->m_slopStenHi[idir] = RefCountedPtr< AggStencil <EBCellFAB, EBCellFAB > >
         (new AggStencil <EBCellFAB, EBCellFAB >(baseindice, basestenhi, dumprim, dumslop));
 
     }
@@ -1075,9 +1129,9 @@ computeFlattening(EBCellFAB&       a_flattening,
                    CHF_BOX(centerBox));
 
       //update the irregular vofsn
-      for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+      for (int ivof = 0; ivof<m_context->m_irregVoFs.size(); ivof++)
         {
-          const VolIndex& vof = m_irregVoFs[ivof];
+          const VolIndex& vof = m_context->m_irregVoFs[ivof];
           if (entireBox.contains(vof.gridIndex()))
             {
               const IntVect&  iv = vof.gridIndex();
@@ -1181,9 +1235,9 @@ computeFlattening(EBCellFAB&       a_flattening,
                    CHF_BOX(entireBox));
 
       //update the irregular vofsn
-      for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+      for (int ivof = 0; ivof<m_context->m_irregVoFs.size(); ivof++)
         {
-          const VolIndex& vof = m_irregVoFs[ivof];
+          const VolIndex& vof = m_context->m_irregVoFs[ivof];
           if (entireBox.contains(vof.gridIndex()))
             {
               const IntVect&  iv = vof.gridIndex();
@@ -1320,9 +1374,9 @@ computeFlattening(EBCellFAB&       a_flattening,
                    CHF_CONST_INT(hasHi),
                    CHF_BOX(centerBox));
 
-      for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+      for (int ivof = 0; ivof<m_context->m_irregVoFs.size(); ivof++)
         {
-          const VolIndex& vof = m_irregVoFs[ivof];
+          const VolIndex& vof = m_context->m_irregVoFs[ivof];
           if (entireBox.contains(vof.gridIndex()))
             {
               const IntVect&  iv = vof.gridIndex();
@@ -1410,9 +1464,9 @@ computeFlattening(EBCellFAB&       a_flattening,
                CHF_CONST_FRA(regDelta1U),
                CHF_BOX(a_box));
 
-  for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+  for (int ivof = 0; ivof<m_context->m_irregVoFs.size(); ivof++)
     {
-      const VolIndex& vof = m_irregVoFs[ivof];
+      const VolIndex& vof = m_context->m_irregVoFs[ivof];
       if (a_box.contains(vof.gridIndex()))
         {
           Real velDiffSum = 0.0;
@@ -1540,8 +1594,8 @@ primitivesAndDivergences(EBCellFAB&          a_nonConsDivF,
 
   for(int faceDir = 0; faceDir < SpaceDim; faceDir++)
     {
-      IntVectSet ivsMinu = m_coveredSetsMinuG4[faceDir] & a_box;
-      IntVectSet ivsPlus = m_coveredSetsPlusG4[faceDir] & a_box;
+      IntVectSet ivsMinu = m_context->m_coveredSetsMinuG4[faceDir] & a_box;
+      IntVectSet ivsPlus = m_context->m_coveredSetsPlusG4[faceDir] & a_box;
       a_coveredPrimMinu[faceDir].define(ivsMinu, m_ebisBox.getEBGraph(), numPrimitives());
       a_coveredPrimPlus[faceDir].define(ivsPlus, m_ebisBox.getEBGraph(), numPrimitives());
       a_coveredPrimMinu[faceDir].copy(a_box, inter, a_box, m_extendStateMinuG4[faceDir], inter);
@@ -1564,8 +1618,8 @@ primitivesAndDivergences(EBCellFAB&          a_nonConsDivF,
       applyArtificialViscosity(a_flux,
                                m_coveredFluxMinuG4,
                                m_coveredFluxPlusG4,
-                               m_coveredFaceMinuG4,
-                               m_coveredFacePlusG4,
+                               m_context->m_coveredFaceMinuG4,
+                               m_context->m_coveredFacePlusG4,
                                a_consState,
                                openDivU,
                                a_box,
@@ -1735,8 +1789,8 @@ extrapolatePrim2D(EBCellFAB           a_primMinu[SpaceDim],
                            m_fluxOne,
                            m_coveredFluxNormMinu,
                            m_coveredFluxNormPlus,
-                           m_coveredFaceMinuG4,
-                           m_coveredFacePlusG4,
+                           m_context->m_coveredFaceMinuG4,
+                           m_context->m_coveredFacePlusG4,
                            a_slopesPrim,
                            a_slopesSeco,
                            a_flattening,
@@ -1753,8 +1807,8 @@ extrapolatePrim2D(EBCellFAB           a_primMinu[SpaceDim],
                 a_primPlus,
                 m_coveredFluxNormMinu,
                 m_coveredFluxNormPlus,
-                m_coveredFaceMinuG4,
-                m_coveredFacePlusG4,
+                m_context->m_coveredFaceMinuG4,
+                m_context->m_coveredFacePlusG4,
                 m_fluxOne,
                 a_primState,
                 a_slopesPrim,
@@ -2186,32 +2240,32 @@ aggIrregSecondOrderSlopes(EBCellFAB&       a_delta2W,
 {
   CH_TIME("agg_irreg_second_order_slopes");
   CH_assert(m_useAgg);
-  CH_assert(a_entireBox == m_entireBox[a_dir]);
-  CH_assert(a_delta2W.getRegion() == m_entireBox[a_dir]);
-  CH_assert(a_deltaWL.getRegion() == m_entireBox[a_dir]);
-  CH_assert(a_deltaWH.getRegion() == m_entireBox[a_dir]);
-  CH_assert(a_deltaWC.getRegion() == m_entireBox[a_dir]);
+  CH_assert(a_entireBox == m_context->m_entireBox[a_dir]);
+  CH_assert(a_delta2W.getRegion() == m_context->m_entireBox[a_dir]);
+  CH_assert(a_deltaWL.getRegion() == m_context->m_entireBox[a_dir]);
+  CH_assert(a_deltaWH.getRegion() == m_context->m_entireBox[a_dir]);
+  CH_assert(a_deltaWC.getRegion() == m_context->m_entireBox[a_dir]);
   CH_assert(a_primState.getRegion() == m_validBoxG4);
   //the slow version has some funky flattening logic that I do
   //not have the time to program into the fast version right now as I
   //am trying to make a deadline for a code that does not use flattening.
 
   //get low and high slopes (or left and right if you prefer)
-  m_slopStenLo[a_dir]->apply(a_deltaWL, a_primState, 0, 0,  numSlopes(), false);
-  m_slopStenHi[a_dir]->apply(a_deltaWH, a_primState, 0, 0,  numSlopes(), false);
+  m_context->m_slopStenLo[a_dir]->apply(a_deltaWL, a_primState, 0, 0,  numSlopes(), false);
+  m_context->m_slopStenHi[a_dir]->apply(a_deltaWH, a_primState, 0, 0,  numSlopes(), false);
 
   //at irregular cells, if one side does not exist,
   //set all to one-sided diffs.  try to do higher order
   //limited diffs if possible.
 
-    for (int ivof = 0; ivof< m_slopVec[a_dir].size(); ivof++)
+    for (int ivof = 0; ivof< m_context->m_slopVec[a_dir].size(); ivof++)
       {
         //slopes have all the same box so they will have the same offset and type
-        const size_t& offsetS = m_slopVec[a_dir][ivof].slop_access.offset;
-        const int   & dataIDS = m_slopVec[a_dir][ivof].slop_access.dataID;
+        const size_t& offsetS = m_context->m_slopVec[a_dir][ivof].slop_access.offset;
+        const int   & dataIDS = m_context->m_slopVec[a_dir][ivof].slop_access.dataID;
 
-        const bool& hasFacesLo = m_slopVec[a_dir][ivof].hasLo;
-        const bool& hasFacesHi = m_slopVec[a_dir][ivof].hasHi;
+        const bool& hasFacesLo = m_context->m_slopVec[a_dir][ivof].hasLo;
+        const bool& hasFacesHi = m_context->m_slopVec[a_dir][ivof].hasHi;
 
         for (int ivar = 0; ivar < numSlopes(); ivar++)
           {
@@ -2348,9 +2402,9 @@ irregSecondOrderSlopes(EBCellFAB&       a_delta2W,
   //limited diffs if possible.
   {
     CH_TIME("irreg_slopes");
-    for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+    for (int ivof = 0; ivof<m_context->m_irregVoFs.size(); ivof++)
       {
-        const VolIndex& vof = m_irregVoFs[ivof];
+        const VolIndex& vof = m_context->m_irregVoFs[ivof];
         if (a_entireBox.contains(vof.gridIndex()))
           {
             for (int ivar = 0; ivar < numSlopes(); ivar++)
@@ -2635,9 +2689,9 @@ doFourthOrderSlopes(EBCellFAB&       a_delta4W,
 
   {
     CH_TIME("irreg4thOrderSlopes");
-    for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+    for (int ivof = 0; ivof<m_context->m_irregVoFs.size(); ivof++)
       {
-        const VolIndex& vof = m_irregVoFs[ivof];
+        const VolIndex& vof = m_context->m_irregVoFs[ivof];
         if (a_box.contains(vof.gridIndex()))
           {
             const IntVect&  iv = vof.gridIndex();
@@ -3732,9 +3786,9 @@ EBPatchReactive::floorPrimitives(EBCellFAB&  a_primState,
                 CHF_REAL(smallp),
                 CHF_REAL(smallu),
                 CHF_REAL(smallr));
-  for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+  for (int ivof = 0; ivof<m_context->m_irregVoFs.size(); ivof++)
     {
-      const VolIndex& vof = m_irregVoFs[ivof];
+      const VolIndex& vof = m_context->m_irregVoFs[ivof];
       if (a_box.contains(vof.gridIndex()))
         {
           a_primState(vof, QRHO)  = Max(a_primState(vof, QRHO) ,  smallr);
@@ -3958,9 +4012,9 @@ updateCons(EBCellFAB&              a_consState,
   //update the irregular vofs
   {
     CH_TIME("EBPatchReactive::updateConsIrregular");
-    for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+    for (int ivof = 0; ivof<m_context->m_irregVoFs.size(); ivof++)
       {
-        const VolIndex& vof = m_irregVoFs[ivof];
+        const VolIndex& vof = m_context->m_irregVoFs[ivof];
         if (a_box.contains(vof.gridIndex()))
           {
             for (SideIterator sit; sit.ok(); ++sit)
@@ -4054,15 +4108,15 @@ cacheEBCF( Vector<Vector<Real> >& a_cache, const  EBCellFAB& a_input)
   a_cache.resize(nvar);
   for (int ivar = 0; ivar < nvar; ivar++)
     {
-      a_cache[ivar].resize(m_irregVoFs.size());
+      a_cache[ivar].resize(m_context->m_irregVoFs.size());
     }
   for (int ivar = 0; ivar < nvar; ivar++)
     {
       const Real* inputSV = a_input.getSingleValuedFAB().dataPtr(ivar);
       const Real* inputMV =  a_input.getMultiValuedFAB().dataPtr(ivar);
-      for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+      for (int ivof = 0; ivof<m_context->m_irregVoFs.size(); ivof++)
         {
-          pointerOffset_t& vofOff = m_updateStencil[ivof].m_vofOffset;
+          pointerOffset_t& vofOff = m_context->m_updateStencil[ivof].m_vofOffset;
           const Real* minuPtr;
           if (vofOff.m_multiValued)
             {
@@ -4090,10 +4144,10 @@ uncacheEBCF(EBCellFAB& a_output, const Vector<Vector<Real> >& a_cache)
       Real* outputSV = a_output.getSingleValuedFAB().dataPtr(ivar);
       Real* outputMV = a_output.getMultiValuedFAB().dataPtr(ivar);
 
-      for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+      for (int ivof = 0; ivof<m_context->m_irregVoFs.size(); ivof++)
         {
-          //const VolIndex& vof = m_irregVoFs[ivof];
-          pointerOffset_t& vofOff = m_updateStencil[ivof].m_vofOffset;
+          //const VolIndex& vof = m_context->m_irregVoFs[ivof];
+          pointerOffset_t& vofOff = m_context->m_updateStencil[ivof].m_vofOffset;
           Real* minuPtr;
           if (vofOff.m_multiValued)
             {
@@ -4141,8 +4195,8 @@ extrapolatePrim3D(EBCellFAB           a_primMinu[SpaceDim],
                            m_fluxOne,
                            m_coveredFluxNormMinu,
                            m_coveredFluxNormPlus,
-                           m_coveredFaceMinuG4,
-                           m_coveredFacePlusG4,
+                           m_context->m_coveredFaceMinuG4,
+                           m_context->m_coveredFacePlusG4,
                            a_slopesPrim,
                            a_slopesSeco,
                            a_flattening,
@@ -4165,8 +4219,8 @@ extrapolatePrim3D(EBCellFAB           a_primMinu[SpaceDim],
                 a_primPlus,
                 m_coveredFluxNormMinu,
                 m_coveredFluxNormPlus,
-                m_coveredFaceMinuG4,
-                m_coveredFacePlusG4,
+                m_context->m_coveredFaceMinuG4,
+                m_context->m_coveredFacePlusG4,
                 m_fluxOne,
                 a_primState,
                 a_slopesPrim,
@@ -4440,14 +4494,14 @@ do111coupling(EBFaceFAB              a_fluxTwo[SpaceDim][SpaceDim],
                                    m_primMinuTemp,
                                    m_primPlusTemp,
                                    a_primState,
-                                   m_coveredFaceMinuG4[faceDir],
+                                   m_context->m_coveredFaceMinuG4[faceDir],
                                    faceDir, Side::Lo, modBoxCov[modDir]);
 
               extrapToCoveredFaces(m_extendStatePlus3D[faceDir][diffDir],
                                    m_primMinuTemp,
                                    m_primPlusTemp,
                                    a_primState,
-                                   m_coveredFacePlusG4[faceDir],
+                                   m_context->m_coveredFacePlusG4[faceDir],
                                    faceDir, Side::Hi, modBoxCov[modDir]);
 
               // Solve the Riemann problem and get fluxes.  Eqution 1.15
@@ -4473,10 +4527,10 @@ do111coupling(EBFaceFAB              a_fluxTwo[SpaceDim][SpaceDim],
               //value in vof to get covered flux.  Equation 1.14
               riemann(a_coveredFluxMinu3D[faceDir][diffDir],
                       m_extendStateMinu3D[faceDir][diffDir], m_primMinuTemp,
-                      m_coveredFaceMinuG4[faceDir], faceDir, Side::Lo, modBoxOpen[faceDir][diffDir]);
+                      m_context->m_coveredFaceMinuG4[faceDir], faceDir, Side::Lo, modBoxOpen[faceDir][diffDir]);
               riemann(a_coveredFluxPlus3D[faceDir][diffDir],
                       m_extendStatePlus3D[faceDir][diffDir], m_primPlusTemp,
-                      m_coveredFacePlusG4[faceDir], faceDir, Side::Hi, modBoxOpen[faceDir][diffDir]);
+                      m_context->m_coveredFacePlusG4[faceDir], faceDir, Side::Hi, modBoxOpen[faceDir][diffDir]);
 
             }
         }
@@ -4524,8 +4578,8 @@ finalExtrap3D(EBCellFAB              a_primMinu[SpaceDim],
                          a_fluxTwo[dir2][dir3],
                          a_coveredFluxMinu3D[dir2][dir3],
                          a_coveredFluxPlus3D[dir2][dir3],
-                         m_coveredFaceMinuG4[dir2],
-                         m_coveredFacePlusG4[dir2],
+                         m_context->m_coveredFaceMinuG4[dir2],
+                         m_context->m_coveredFacePlusG4[dir2],
                          dir2,  slopeBoxG1,  (0.5)*m_dt/m_dx[dir2]);
 
             }
@@ -4962,9 +5016,9 @@ nonconservativeDivergence(EBCellFAB&             a_divF,
 
     }
   //update the irregular vofsn
-    for (int ivof = 0; ivof<m_irregVoFs.size(); ivof++)
+    for (int ivof = 0; ivof<m_context->m_irregVoFs.size(); ivof++)
       {
-        const VolIndex& vof = m_irregVoFs[ivof];
+        const VolIndex& vof = m_context->m_irregVoFs[ivof];
         if (a_box.contains(vof.gridIndex()))
           {
             //divergence was set in regular update.  we reset it
@@ -5274,38 +5328,139 @@ interpolateFluxToCentroids(BaseIFFAB<Real>              a_centroidFlux[SpaceDim]
   //could just use numFluxes but this allows unit testing
   //with a single variable interpolant
   int nflux = a_centroidFlux[0].nComp();
-  //now loop through the irregular faces
+  //every face stencil is applied to all the variables in one pass
   for (int faceDir = 0; faceDir < SpaceDim; faceDir++)
     {
       BaseIFFAB<Real>& fluxDir = a_centroidFlux[faceDir];
       const BaseIFFAB<Real>& interpol = *(a_fluxInterpolant[faceDir]);
-      const BaseIFFAB<FaceStencil>& stencils = m_interpStencils[faceDir];
+      CH_assert(interpol.nComp() >= nflux);
+
+      //recompile if any of the sets the offsets were taken from changed
+      flatStencil_t& flat = m_context->m_interpFlat[faceDir];
+      IntVectSet* sets = m_context->m_interpIVS[faceDir];
+      if (!m_context->m_interpCompiled[faceDir] ||
+          !(sets[0] == a_irregIVS) ||
+          !(sets[1] == fluxDir.getIVS()) ||
+          !(sets[2] == interpol.getIVS()))
+        {
+          compileInterpStencil(flat, m_context->m_interpStencils[faceDir],
+                               fluxDir, interpol, a_irregIVS, faceDir);
+          sets[0] = a_irregIVS;
+          sets[1] = fluxDir.getIVS();
+          sets[2] = interpol.getIVS();
+          m_context->m_interpCompiled[faceDir] = true;
+        }
+      if (flat.m_dstOffset.size() == 0) continue;
 
-      for (FaceIterator faceit(a_irregIVS, m_ebisBox.getEBGraph(), faceDir, stopCrit);
-          faceit.ok(); ++faceit)
+      Real*       dstPtr    = fluxDir.dataPtr(0);
+      const Real* srcPtr    = interpol.dataPtr(0);
+      long        dstStride = fluxDir.numFaces();
+      long        srcStride = interpol.numFaces();
+      for (int iface = 0; iface < flat.m_dstOffset.size(); iface++)
         {
-          const FaceIndex& centFace = faceit();
-          const FaceStencil& sten = stencils(centFace, 0);
+          const long dstOff = flat.m_dstOffset[iface];
+          const int  ibeg   = flat.m_begin[iface];
+          const int  iend   = flat.m_begin[iface+1];
           for (int ivar = 0; ivar < nflux; ivar++)
             {
+              const Real* src = srcPtr + ivar*srcStride;
               Real newFlux = 0.0;
-              for (int isten = 0; isten < sten.size(); isten++)
+              for (int isten = ibeg; isten < iend; isten++)
                 {
-                  const FaceIndex& stenFace= sten.face(isten);
-                  Real weight = sten.weight(isten);
-                  Real interpFlux = interpol(stenFace, ivar);
-                  newFlux += weight*interpFlux;
+                  newFlux += flat.m_weight[isten]*src[flat.m_srcOffset[isten]];
                 }
-              fluxDir(centFace, ivar) = newFlux;
+              dstPtr[dstOff + ivar*dstStride] = newFlux;
             }
+        }
+    }
+}
+/*****************************/
+void
+EBPatchReactive::
+compileInterpStencil(flatStencil_t&                a_flat,
+                     const BaseIFFAB<FaceStencil>& a_stencils,
+                     const BaseIFFAB<Real>&        a_centroidFlux,
+                     const BaseIFFAB<Real>&        a_interpolant,
+                     const IntVectSet&             a_irregIVS,
+                     int                           a_faceDir)
+{
+  CH_TIME("EBPatchReactive::compileInterpStencil");
+  a_flat.m_dstOffset.resize(0);
+  a_flat.m_begin.resize(0);
+  a_flat.m_srcOffset.resize(0);
+  a_flat.m_srcType.resize(0);
+  a_flat.m_weight.resize(0);
+
+  const Real* dstStart = a_centroidFlux.dataPtr(0);
+  const Real* srcStart = a_interpolant.dataPtr(0);
+  FaceStop::WhichFaces stopCrit = FaceStop::SurroundingWithBoundary;
+  for (FaceIterator faceit(a_irregIVS, m_ebisBox.getEBGraph(), a_faceDir, stopCrit);
+      faceit.ok(); ++faceit)
+    {
+      const FaceIndex& centFace = faceit();
+      const FaceStencil& sten = a_stencils(centFace, 0);
+      a_flat.m_begin.push_back(a_flat.m_weight.size());
+      a_flat.m_dstOffset.push_back(a_centroidFlux.getIndex(centFace, 0) - dstStart);
+      for (int isten = 0; isten < sten.size(); isten++)
+        {
+          a_flat.m_srcOffset.push_back(a_interpolant.getIndex(sten.face(isten), 0) - srcStart);
+          a_flat.m_srcType.push_back(0);
+          a_flat.m_weight.push_back(sten.weight(isten));
+        }
+    }
+  a_flat.m_begin.push_back(a_flat.m_weight.size());
+}
+/*****************************/
+void
+EBPatchReactive::
+compileDivergenceStencil(flatStencil_t&    a_flat,
+                         const IntVectSet& a_irregIVS)
+{
+  CH_TIME("EBPatchReactive::compileDivergenceStencil");
+  a_flat.m_dstOffset.resize(0);
+  a_flat.m_begin.resize(0);
+  a_flat.m_srcOffset.resize(0);
+  a_flat.m_srcType.resize(0);
+  a_flat.m_weight.resize(0);
+
+  //offsets do not depend on the number of components
+  const EBGraph& ebgraph = m_ebisBox.getEBGraph();
+  BaseIVFAB<Real> cellShape(a_irregIVS, ebgraph, 1);
+  BaseIFFAB<Real> faceShape[SpaceDim];
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      faceShape[idir].define(a_irregIVS, ebgraph, idir, 1);
+    }
 
-          //debug!  turn off interpolation
-          // for (int ivar = 0; ivar < numFluxes(); ivar++)
-          //   {
-          //     fluxDir(centFace, ivar) = interpol(centFace, ivar);
-          //   }
+  for (VoFIterator vofit(a_irregIVS, ebgraph); vofit.ok(); ++vofit)
+    {
+      const VolIndex& vof = vofit();
+      long cellOff = cellShape.offset(vof, 0);
+      a_flat.m_begin.push_back(a_flat.m_weight.size());
+      a_flat.m_dstOffset.push_back(cellOff);
+      for (int idir = 0; idir < SpaceDim; idir++)
+        {
+          const Real* faceStart = faceShape[idir].dataPtr(0);
+          for (SideIterator sit; sit.ok(); ++sit)
+            {
+              int isign = sign(sit());
+              Vector<FaceIndex> faces = m_ebisBox.getFaces(vof, idir, sit());
+              for (int iface = 0; iface < faces.size(); iface++)
+                {
+                  const FaceIndex& face = faces[iface];
+                  Real areaFrac = m_ebisBox.areaFrac(face);
+                  a_flat.m_srcOffset.push_back(faceShape[idir].getIndex(face, 0) - faceStart);
+                  a_flat.m_srcType.push_back(idir);
+                  a_flat.m_weight.push_back(isign*areaFrac/m_dx[idir]);
+                }
+            }
         }
+      //EB boundary flux, same layout as the divergence
+      a_flat.m_srcOffset.push_back(cellOff);
+      a_flat.m_srcType.push_back(SpaceDim);
+      a_flat.m_weight.push_back(m_ebisBox.bndryArea(vof)*m_dxScale);
     }
+  a_flat.m_begin.push_back(a_flat.m_weight.size());
 }
 void 
 EBPatchReactive::
@@ -5369,41 +5524,53 @@ consUndividedDivergence(BaseIVFAB<Real>&       a_divF,
   CH_TIME("EBPatchReactive::consUndividedDivergence");
   CH_assert(m_isDefined);
   CH_assert(m_isBoxSet);
+  //the offsets assume every holder is defined over a_ivs
+  CH_assert(a_divF.getIVS() == a_ivs);
+  CH_assert(a_ebIrregFlux.getIVS() == a_ivs);
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      CH_assert(a_centroidFlux[idir].getIVS() == a_ivs);
+    }
   int ncons = a_divF.nComp();
   a_divF.setVal(0.0);
-  for (VoFIterator vofit(a_ivs, m_ebisBox.getEBGraph());
-      vofit.ok(); ++vofit)
+  //the stencil compiled with the context covers the irregular vofs of
+  //the bound box.  rebuild it if we are asked for another set.
+  if (!(m_context->m_divIVS == a_ivs))
     {
-      const VolIndex& vof = vofit();
+      compileDivergenceStencil(m_context->m_divFlat, a_ivs);
+      m_context->m_divIVS = a_ivs;
+    }
+  const flatStencil_t& flat = m_context->m_divFlat;
+  if (flat.m_dstOffset.size() == 0) return;
+
+  //centroid fluxes are types 0 to SpaceDim-1, the EB flux is type SpaceDim
+  const Real* srcPtr[SpaceDim+1];
+  long        srcStride[SpaceDim+1];
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      srcPtr[idir]    = a_centroidFlux[idir].dataPtr(0);
+      srcStride[idir] = a_centroidFlux[idir].numFaces();
+    }
+  srcPtr[SpaceDim]    = a_ebIrregFlux.dataPtr(0);
+  srcStride[SpaceDim] = a_ebIrregFlux.numVoFs();
 
-      Real bndryArea = m_ebisBox.bndryArea(vof);
+  Real* dstPtr    = a_divF.dataPtr(0);
+  long  dstStride = a_divF.numVoFs();
+  for (int ivof = 0; ivof < flat.m_dstOffset.size(); ivof++)
+    {
+      const long dstOff = flat.m_dstOffset[ivof];
+      const int  ibeg   = flat.m_begin[ivof];
+      const int  iend   = flat.m_begin[ivof+1];
       for (int ivar = 0; ivar < ncons ; ivar++)
         {
-          Real bndryFlux = a_ebIrregFlux(vof,ivar);
           Real update = 0.;
-          for ( int idir = 0; idir < SpaceDim; idir++)
+          for (int isten = ibeg; isten < iend; isten++)
             {
-              const BaseIFFAB<Real>& fluxDir = a_centroidFlux[idir];
-              for (SideIterator sit; sit.ok(); ++sit)
-                {
-                  int isign = sign(sit());
-                  Vector<FaceIndex> faces =
-                    m_ebisBox.getFaces(vof, idir, sit());
-                  for (int iface = 0; iface < faces.size(); iface++)
-                    {
-                      const FaceIndex& face = faces[iface];
-                      Real areaFrac = m_ebisBox.areaFrac(face);
-                      Real faceFlux = fluxDir(face, ivar);
-                      update += isign*areaFrac*faceFlux/m_dx[idir];
-                    }
-                }
+              const int itype = flat.m_srcType[isten];
+              update += flat.m_weight[isten]*srcPtr[itype][flat.m_srcOffset[isten] + ivar*srcStride[itype]];
             }
-
-          //add EB boundary conditions in divergence
-          update += bndryFlux*bndryArea*m_dxScale;
           //note NOT divided by volfrac
-          a_divF(vof, ivar) = update;
-          a_divF(vof, ivar) = update;
+          dstPtr[dstOff + ivar*dstStride] = update;
         } //end loop over variables
     } //end loop over vofs
 }
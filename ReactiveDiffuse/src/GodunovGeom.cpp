@@ -35,6 +35,7 @@
 // #include "EBMenagerieUtils.H"
 #include "BRMeshRefine.H"
 #include "parstream.H"
+#include "SPMD.H"
 #include "PolyGeom.H"
 //#include "ModianoIBCFactory.H"
 #include "EBAMRGodunovFactory.H"
@@ -547,7 +548,32 @@ godunovGeometry(Box& a_coarsestDomain,
   ppgodunov.get("max_grid_size", ebMaxSize);
   EBIndexSpace* ebisPtr = Chombo_EBIS::instance();
   int verbosity = 0;
-  if (!pp.contains("ebis_file"))
+
+  //ebis_cache_file is written by the first run and read back by the restarts,
+  //whatever their number of ranks
+  std::string ebis_file;
+  bool readGeometry = pp.contains("ebis_file");
+  bool writeGeometry = false;
+  if (readGeometry)
+    {
+      pp.get("ebis_file",ebis_file);
+    }
+  else if (pp.contains("ebis_cache_file"))
+    {
+      pp.get("ebis_cache_file",ebis_file);
+      //every rank has to take the same branch
+      int exists = 0;
+      if (procID() == uniqueProc(SerialTask::compute))
+        {
+          FILE* test = fopen(ebis_file.c_str(), "r");
+          exists = (test != NULL);
+          if (test != NULL) fclose(test);
+        }
+      broadcast(exists, uniqueProc(SerialTask::compute));
+      readGeometry = (exists != 0);
+      writeGeometry = !readGeometry;
+    }
+  if (!readGeometry)
     {
       if (whichgeom == 0)
         {
@@ -1215,14 +1241,22 @@ godunovGeometry(Box& a_coarsestDomain,
     }
   else
     {
-      std::string ebis_file;
-      pp.get("ebis_file",ebis_file);
       pout() << " recreating geometry from file " << ebis_file << endl;
       //define ebis anew from file input
 #ifdef CH_USE_HDF5
       HDF5Handle handleIn(ebis_file, HDF5Handle::OPEN_RDONLY);
       ebisPtr->define(handleIn);
       handleIn.close();
+#endif
+    }
+
+  if (writeGeometry)
+    {
+      pout() << " caching geometry in file " << ebis_file << endl;
+#ifdef CH_USE_HDF5
+      HDF5Handle handleOut(ebis_file, HDF5Handle::CREATE);
+      ebisPtr->write(handleOut);
+      handleOut.close();
 #endif
     }
 }
@@ -0,0 +1,106 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <cstdio>
+#include <sys/time.h>
+
+#include "ReactiveBenchmark.H"
+#include "SPMD.H"
+#include "parstream.H"
+
+using std::endl;
+
+Real      ReactiveBenchmark::s_seconds[ReactiveBenchmark::NumPhases];
+long long ReactiveBenchmark::s_cells[ReactiveBenchmark::NumPhases];
+long long ReactiveBenchmark::s_stepCells = 0;
+
+/***************************/
+void ReactiveBenchmark::add(Phase a_phase, Real a_seconds, long long a_cells)
+{
+  s_seconds[a_phase] += a_seconds;
+  s_cells[a_phase]   += a_cells;
+}
+/***************************/
+void ReactiveBenchmark::reset()
+{
+  for (int iphase = 0; iphase < NumPhases; iphase++)
+    {
+      s_seconds[iphase] = 0;
+      s_cells[iphase]   = 0;
+    }
+  s_stepCells = 0;
+}
+/***************************/
+Real ReactiveBenchmark::wallTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (Real)tv.tv_sec + 1.0e-6*(Real)tv.tv_usec;
+}
+/***************************/
+const char* ReactiveBenchmark::phaseName(Phase a_phase)
+{
+  static const char* names[NumPhases] = {"hyperbolic", "mc_diffusion", "viscosity",
+                                         "conductivity", "chemistry", "regrid", "io"};
+  return names[a_phase];
+}
+/***************************/
+void ReactiveBenchmark::write(const std::string& a_fileName,
+                              const std::string& a_case,
+                              const std::string& a_tag,
+                              Real               a_totalTime)
+{
+  //the slowest rank sets the time, every rank contributes its cells
+  Real      seconds[NumPhases];
+  long long cells[NumPhases];
+  Real      totalTime = a_totalTime;
+  long long totalCells = s_stepCells;
+#ifdef CH_MPI
+  MPI_Reduce(s_seconds, seconds, NumPhases, MPI_CH_REAL, MPI_MAX, 0, Chombo_MPI::comm);
+  MPI_Reduce(s_cells, cells, NumPhases, MPI_LONG_LONG, MPI_SUM, 0, Chombo_MPI::comm);
+  MPI_Reduce(&a_totalTime, &totalTime, 1, MPI_CH_REAL, MPI_MAX, 0, Chombo_MPI::comm);
+  MPI_Reduce(&s_stepCells, &totalCells, 1, MPI_LONG_LONG, MPI_SUM, 0, Chombo_MPI::comm);
+#else
+  for (int iphase = 0; iphase < NumPhases; iphase++)
+    {
+      seconds[iphase] = s_seconds[iphase];
+      cells[iphase]   = s_cells[iphase];
+    }
+#endif
+  if (procID() != 0) return;
+
+  FILE* test = fopen(a_fileName.c_str(), "r");
+  bool isNew = (test == NULL);
+  if (test != NULL) fclose(test);
+
+  FILE* out = fopen(a_fileName.c_str(), "a");
+  if (out == NULL)
+    {
+      pout() << "ReactiveBenchmark: could not open " << a_fileName << endl;
+      return;
+    }
+  if (isNew)
+    {
+      fprintf(out, "tag,case,nproc,phase,seconds,cell_updates,cell_updates_per_sec\n");
+    }
+  for (int iphase = 0; iphase < NumPhases; iphase++)
+    {
+      Real rate = (seconds[iphase] > 0) ? cells[iphase]/seconds[iphase] : 0;
+      fprintf(out, "%s,%s,%d,%s,%.6e,%lld,%.6e\n", a_tag.c_str(), a_case.c_str(), numProc(),
+              phaseName((Phase)iphase), seconds[iphase], cells[iphase], rate);
+    }
+  //whole-run throughput in cells advanced per second
+  Real rate = (totalTime > 0) ? totalCells/totalTime : 0;
+  fprintf(out, "%s,%s,%d,%s,%.6e,%lld,%.6e\n", a_tag.c_str(), a_case.c_str(), numProc(),
+          "total", totalTime, totalCells, rate);
+  fclose(out);
+
+  pout() << "benchmark results for " << a_case << " appended to " << a_fileName << endl;
+}
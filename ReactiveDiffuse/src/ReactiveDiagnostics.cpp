@@ -0,0 +1,251 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <cstdio>
+
+#include "ReactiveDiagnostics.H"
+#include "EBAMRReactive.H"
+#include "AMR.H"
+#include "ParmParse.H"
+#include "SPMD.H"
+#include "parstream.H"
+
+using std::endl;
+
+/***************************/
+ReactiveDiagnostics::ReactiveDiagnostics()
+  :m_amr(NULL),
+   m_fileName("diagnostics.csv"),
+   m_slicePrefix("slice"),
+   m_lastStep(-1),
+   m_varsDefined(false),
+   m_heatRelease(false),
+   m_frontVar(-1),
+   m_frontValue(0),
+   m_frontDir(0)
+{
+  ParmParse pp;
+  pp.query("diagnostics_file", m_fileName);
+  pp.query("diagnostics_slice_prefix", m_slicePrefix);
+  int heatRelease = 0;
+  pp.query("diagnostics_heat_release", heatRelease);
+  m_heatRelease = (heatRelease != 0);
+  if (pp.contains("diagnostics_front_var"))
+    {
+      pp.get("diagnostics_front_var", m_frontName);
+      pp.get("diagnostics_front_value", m_frontValue);
+      pp.query("diagnostics_front_dir", m_frontDir);
+      if ((m_frontDir < 0) || (m_frontDir >= SpaceDim))
+        {
+          MayDay::Error("ReactiveDiagnostics: bad diagnostics_front_dir");
+        }
+    }
+  if (pp.contains("diagnostics_slice_dirs"))
+    {
+      int nslice = pp.countval("diagnostics_slice_dirs");
+      pp.getarr("diagnostics_slice_dirs", m_sliceDirs, 0, nslice);
+      pp.getarr("diagnostics_slice_positions", m_slicePositions, 0, nslice);
+      for (int islice = 0; islice < nslice; islice++)
+        {
+          if ((m_sliceDirs[islice] < 0) || (m_sliceDirs[islice] >= SpaceDim))
+            {
+              MayDay::Error("ReactiveDiagnostics: bad diagnostics_slice_dirs");
+            }
+        }
+    }
+
+  //only then does the chemistry step measure it
+  if (m_heatRelease)
+    {
+      EBAMRReactive::s_trackHeatRelease = true;
+    }
+}
+/***************************/
+ReactiveDiagnostics::~ReactiveDiagnostics()
+{
+}
+/***************************/
+void ReactiveDiagnostics::setUp(AMR& a_AMR, int a_interval)
+{
+  m_amr = &a_AMR;
+}
+/***************************/
+void ReactiveDiagnostics::setUp(AMR& a_AMR, Real a_interval)
+{
+  m_amr = &a_AMR;
+}
+/***************************/
+bool ReactiveDiagnostics::isActive() const
+{
+  ParmParse pp;
+  return (m_heatRelease || (m_frontName.size() > 0) || (m_sliceDirs.size() > 0) ||
+          pp.contains("diagnostics_integrals") ||
+          pp.contains("diagnostics_max") ||
+          pp.contains("diagnostics_min"));
+}
+/***************************/
+EBAMRReactive* ReactiveDiagnostics::level0() const
+{
+  CH_assert(m_amr != NULL);
+  EBAMRReactive* level0 = dynamic_cast<EBAMRReactive*>(m_amr->getAMRLevels()[0]);
+  if (level0 == NULL)
+    {
+      MayDay::Error("ReactiveDiagnostics: level 0 is not an EBAMRReactive");
+    }
+  return level0;
+}
+/***************************/
+void ReactiveDiagnostics::defineVariables(const EBAMRReactive& a_level0)
+{
+  const char* keys[3] = {"diagnostics_integrals", "diagnostics_max", "diagnostics_min"};
+  Vector<int>* lists[3] = {&m_integrals, &m_maxs, &m_mins};
+  for (int ilist = 0; ilist < 3; ilist++)
+    {
+      Vector<int> vars;
+      Vector<string> names;
+      a_level0.diagnosticVariables(vars, names, keys[ilist]);
+      lists[ilist]->resize(0);
+      for (int i = 0; i < vars.size(); i++)
+        {
+          int index = -1;
+          for (int j = 0; j < m_vars.size(); j++)
+            {
+              if (m_vars[j] == vars[i])
+                {
+                  index = j;
+                }
+            }
+          if (index < 0)
+            {
+              index = m_vars.size();
+              m_vars.push_back(vars[i]);
+              m_names.push_back(names[i]);
+            }
+          lists[ilist]->push_back(index);
+        }
+    }
+
+  if (m_frontName.size() > 0)
+    {
+      Vector<int> vars;
+      Vector<string> names;
+      a_level0.diagnosticVariables(vars, names, "diagnostics_front_var");
+      if (vars.size() != 1)
+        {
+          MayDay::Error("ReactiveDiagnostics: diagnostics_front_var takes one variable");
+        }
+      m_frontVar = vars[0];
+    }
+  if (m_sliceDirs.size() > 0)
+    {
+      Vector<string> names;
+      a_level0.diagnosticVariables(m_sliceVars, names, "diagnostics_slice_vars");
+    }
+  m_varsDefined = true;
+}
+/***************************/
+void ReactiveDiagnostics::writeHeader(FILE* a_out) const
+{
+  fprintf(a_out, "step,time");
+  for (int i = 0; i < m_integrals.size(); i++)
+    {
+      fprintf(a_out, ",integral(%s)", m_names[m_integrals[i]].c_str());
+    }
+  for (int i = 0; i < m_maxs.size(); i++)
+    {
+      fprintf(a_out, ",max(%s)", m_names[m_maxs[i]].c_str());
+    }
+  for (int i = 0; i < m_mins.size(); i++)
+    {
+      fprintf(a_out, ",min(%s)", m_names[m_mins[i]].c_str());
+    }
+  if (m_frontVar >= 0)
+    {
+      fprintf(a_out, ",front(%s>%g)", m_frontName.c_str(), m_frontValue);
+    }
+  if (m_heatRelease)
+    {
+      fprintf(a_out, ",heat_release_rate");
+    }
+  fprintf(a_out, "\n");
+}
+/***************************/
+void ReactiveDiagnostics::operator()(int a_step, Real a_time)
+{
+  CH_TIME("ReactiveDiagnostics::operator()");
+  EBAMRReactive* level = level0();
+  if (!m_varsDefined)
+    {
+      defineVariables(*level);
+    }
+  m_lastStep = a_step;
+
+  Vector<Real> integral, maxs, mins;
+  Real front, heatRelease;
+  level->compositeReductions(integral, maxs, mins, front, heatRelease,
+                             m_vars, m_frontVar, m_frontValue, m_frontDir);
+
+#ifdef CH_USE_HDF5
+  for (int islice = 0; islice < m_sliceDirs.size(); islice++)
+    {
+      char fileName[1000];
+      sprintf(fileName, "%s%d.%06d.%dd.hdf5", m_slicePrefix.c_str(), islice, a_step, SpaceDim);
+      level->writeSliceFile(fileName, m_sliceVars, m_sliceDirs[islice], m_slicePositions[islice]);
+    }
+#endif
+
+  if (procID() != 0) return;
+
+  FILE* test = fopen(m_fileName.c_str(), "r");
+  bool isNew = (test == NULL);
+  if (test != NULL) fclose(test);
+
+  FILE* out = fopen(m_fileName.c_str(), "a");
+  if (out == NULL)
+    {
+      pout() << "ReactiveDiagnostics: could not open " << m_fileName << endl;
+      return;
+    }
+  if (isNew)
+    {
+      writeHeader(out);
+    }
+  fprintf(out, "%d,%.10e", a_step, a_time);
+  for (int i = 0; i < m_integrals.size(); i++)
+    {
+      fprintf(out, ",%.10e", integral[m_integrals[i]]);
+    }
+  for (int i = 0; i < m_maxs.size(); i++)
+    {
+      fprintf(out, ",%.10e", maxs[m_maxs[i]]);
+    }
+  for (int i = 0; i < m_mins.size(); i++)
+    {
+      fprintf(out, ",%.10e", mins[m_mins[i]]);
+    }
+  if (m_frontVar >= 0)
+    {
+      fprintf(out, ",%.10e", front);
+    }
+  if (m_heatRelease)
+    {
+      fprintf(out, ",%.10e", heatRelease);
+    }
+  fprintf(out, "\n");
+  fclose(out);
+}
+/***************************/
+void ReactiveDiagnostics::conclude(int a_step, Real a_time)
+{
+  if (a_step != m_lastStep)
+    {
+      (*this)(a_step, a_time);
+    }
+}
@@ -17,9 +17,11 @@
 #include "memusage.H"
 #include <fstream>
 #include <set>
+#include <map>
 #include <vector>
 #include <cstdio>
 #include "CH_assert.H"
+#include "Misc.H"
 #include "parstream.H"
 #include <cstring>
 #ifndef CH_DISABLE_SIGNALS
@@ -64,6 +66,7 @@ std::vector<TraceTimer*> TraceTimer::s_currentTimer;
 long long int TraceTimer::s_peak = 0;
 TraceTimer*  TraceTimer::s_peakTimer = NULL;
 bool TraceTimer::s_traceMemory = false;
+int  TraceTimer::s_levelTag = -1;
 static int s_depth = TraceTimer::initializer();
 
 double zeroTime = 0;
@@ -614,6 +617,184 @@ void TraceTimer::reportMemoryOneTree(FILE* out, const TraceTimer& timer)
 
 }
 
+void TraceTimer::exportRecords(std::string& a_buf, const TraceTimer& a_timer,
+                               const std::string& a_parentPath, int a_depth)
+{
+  if (a_timer.m_pruned) return;
+  char buf[1024];
+  std::string path = a_parentPath;
+  if (a_depth > 0) path += "/";
+  path += a_timer.m_name;
+  if (a_timer.m_level >= 0)
+    {
+      sprintf(buf, "@L%d", a_timer.m_level);
+      path += buf;
+    }
+  // one record per line: path name level depth count seconds
+  a_buf += path;
+  a_buf += "\t";
+  a_buf += a_timer.m_name;
+  sprintf(buf, "\t%d\t%d\t%lld\t%.6e\n", a_timer.m_level, a_depth, a_timer.m_count,
+          a_timer.m_accumulated_WCtime*secondspertick);
+  a_buf += buf;
+  for (int i=0; i<a_timer.m_children.size(); ++i)
+    {
+      exportRecords(a_buf, *(a_timer.m_children[i]), path, a_depth+1);
+    }
+}
+
+struct ExportStat
+{
+  std::string   name;
+  int           level;
+  int           depth;
+  int           nranks;
+  long long int cmin, cmax, csum;
+  double        tmin, tmax, tsum;
+};
+
+static std::string jsonEscape(const std::string& a_str)
+{
+  std::string rtn;
+  for (int i=0; i<a_str.size(); ++i)
+    {
+      char c = a_str[i];
+      if (c == '"' || c == '\\') rtn += '\\';
+      rtn += c;
+    }
+  return rtn;
+}
+
+void TraceTimer::exportTree(int a_step, const char* a_format)
+{
+  TraceTimer& root = *(s_roots[0]); // in MThread code, loop over roots
+  if (root.m_pruned) return; //CH_TIMER not set, timers inactive
+  bool csv = (strcmp(a_format, "csv") == 0);
+  if (!csv && strcmp(a_format, "json") != 0)
+    {
+      MayDay::Error("TraceTimer::exportTree: format must be json or csv");
+    }
+  root.currentize();
+  double elapsedTime = TimerGetTimeStampWC() - zeroTime;
+  unsigned long long int elapsedTicks = ch_ticks() - zeroTicks;
+  secondspertick = elapsedTime/(double)elapsedTicks;
+
+  std::string local;
+  exportRecords(local, root, std::string(), 0);
+
+  int nproc = 1;
+  std::vector<int> offsets(1, 0);
+  std::vector<char> all(local.begin(), local.end());
+#ifdef CH_MPI
+  nproc = numProc();
+  int len = local.size();
+  std::vector<int> lens(nproc, 0);
+  MPI_Gather(&len, 1, MPI_INT, &lens[0], 1, MPI_INT, 0, Chombo_MPI::comm);
+  offsets.assign(nproc+1, 0);
+  for (int i=0; i<nproc; ++i) offsets[i+1] = offsets[i] + lens[i];
+  all.assign(offsets[nproc]+1, 0);
+  MPI_Gatherv((void*)local.c_str(), len, MPI_CHAR, &all[0], &lens[0], &offsets[0],
+              MPI_CHAR, 0, Chombo_MPI::comm);
+  if (procID() != 0) return;
+#else
+  offsets.push_back(all.size());
+#endif
+
+  // merge on the path; keep first-seen order so the output stays a preorder walk
+  std::map<std::string, ExportStat> stats;
+  std::vector<std::string> order;
+  for (int irank=0; irank<nproc; ++irank)
+    {
+      std::string chunk(all.begin()+offsets[irank], all.begin()+offsets[irank+1]);
+      size_t pos = 0;
+      while (pos < chunk.size())
+        {
+          size_t eol = chunk.find('\n', pos);
+          if (eol == std::string::npos) eol = chunk.size();
+          std::string line = chunk.substr(pos, eol-pos);
+          pos = eol+1;
+          size_t t0 = line.find('\t');
+          size_t t1 = line.find('\t', t0+1);
+          if (t0 == std::string::npos || t1 == std::string::npos) continue;
+          std::string path = line.substr(0, t0);
+          int level, depth;
+          long long int count;
+          double seconds;
+          sscanf(line.c_str()+t1+1, "%d %d %lld %le", &level, &depth, &count, &seconds);
+          std::map<std::string, ExportStat>::iterator it = stats.find(path);
+          if (it == stats.end())
+            {
+              ExportStat s;
+              s.name = line.substr(t0+1, t1-t0-1);
+              s.level = level;
+              s.depth = depth;
+              s.nranks = 1;
+              s.cmin = s.cmax = s.csum = count;
+              s.tmin = s.tmax = s.tsum = seconds;
+              stats[path] = s;
+              order.push_back(path);
+            }
+          else
+            {
+              ExportStat& s = it->second;
+              s.nranks++;
+              s.cmin = Min(s.cmin, count);
+              s.cmax = Max(s.cmax, count);
+              s.csum += count;
+              s.tmin = Min(s.tmin, seconds);
+              s.tmax = Max(s.tmax, seconds);
+              s.tsum += seconds;
+            }
+        }
+    }
+
+  static FILE* outFiles[2] = {NULL, NULL};
+  FILE*& out = outFiles[csv ? 1 : 0];
+  if (out == NULL)
+    {
+      out = fopen(csv ? "time.table.csv" : "time.table.json", "w");
+      if (out == NULL) return;
+      if (csv)
+        {
+          fprintf(out, "step,elapsed,path,name,level,depth,ranks,"
+                  "count_min,count_max,count_avg,time_min,time_max,time_avg\n");
+        }
+    }
+  if (!csv)
+    {
+      fprintf(out, "{\"step\":%d,\"elapsed\":%.6e,\"nproc\":%d,\"timers\":[",
+              a_step, elapsedTime, nproc);
+    }
+  for (int i=0; i<order.size(); ++i)
+    {
+      ExportStat& s = stats[order[i]];
+      // ranks that never reached this timer count as zero
+      if (s.nranks < nproc)
+        {
+          s.cmin = 0;
+          s.tmin = 0;
+        }
+      double cavg = (double)s.csum/nproc;
+      double tavg = s.tsum/nproc;
+      if (csv)
+        {
+          fprintf(out, "%d,%.6e,\"%s\",\"%s\",%d,%d,%d,%lld,%lld,%.6e,%.6e,%.6e,%.6e\n",
+                  a_step, elapsedTime, order[i].c_str(), s.name.c_str(), s.level, s.depth,
+                  s.nranks, s.cmin, s.cmax, cavg, s.tmin, s.tmax, tavg);
+        }
+      else
+        {
+          fprintf(out, "%s{\"path\":\"%s\",\"name\":\"%s\",\"level\":%d,\"depth\":%d,\"ranks\":%d,"
+                  "\"count\":{\"min\":%lld,\"max\":%lld,\"avg\":%.6e},"
+                  "\"time\":{\"min\":%.6e,\"max\":%.6e,\"avg\":%.6e}}",
+                  (i > 0) ? "," : "", jsonEscape(order[i]).c_str(), jsonEscape(s.name).c_str(),
+                  s.level, s.depth, s.nranks, s.cmin, s.cmax, cavg, s.tmin, s.tmax, tavg);
+        }
+    }
+  if (!csv) fprintf(out, "]}\n");
+  fflush(out);
+}
+
 // some compilers complain if there isn't at least 1 non-inlined
 // function for every class.  These two are mostly to make those compilers happy
 
@@ -647,7 +828,7 @@ TraceTimer* TraceTimer::getTimer(const char* name)
   for (; i<children.size(); ++i)
   {
     TraceTimer* timer =  children[i];
-    if (timer->m_name == name) return timer;
+    if (timer->m_name == name && timer->m_level == s_levelTag) return timer;
   }
   TraceTimer* newTimer = new TraceTimer(name, parent, thread_id);
   children.push_back(newTimer);
@@ -657,7 +838,7 @@ TraceTimer* TraceTimer::getTimer(const char* name)
 TraceTimer::TraceTimer(const char* a_name, TraceTimer* parent, int thread_id)
   :m_pruned(false), m_parent(parent), m_name(a_name), m_count(0),
    m_accumulated_WCtime(0),m_last_WCtime_stamp(0), m_thread_id(thread_id),
-   m_memory(0), m_peak(0)
+   m_memory(0), m_peak(0), m_level(s_levelTag)
 {
 
 }
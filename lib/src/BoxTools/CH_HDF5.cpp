@@ -407,6 +407,52 @@ hid_t HDF5Handle::box_id = 0;
 hid_t HDF5Handle::intvect_id = 0;
 hid_t HDF5Handle::realvect_id = 0;
 map<std::string, std::string> HDF5Handle::groups = map<std::string, std::string>();
+bool HDF5Handle::s_aggregatedWrite = false;
+int  HDF5Handle::s_numWriters = 0;
+int  HDF5Handle::s_deflateLevel = 0;
+bool HDF5Handle::s_shuffle = true;
+int  HDF5Handle::s_chunkSize = 65536;
+
+void HDF5Handle::setAggregatedWrite(bool a_aggregatedWrite)
+{
+  s_aggregatedWrite = a_aggregatedWrite;
+}
+
+void HDF5Handle::setNumWriters(int a_numWriters)
+{
+  CH_assert(a_numWriters >= 0);
+  s_numWriters = a_numWriters;
+}
+
+void HDF5Handle::setCompression(int  a_deflateLevel,
+                                bool a_shuffle,
+                                int  a_chunkSize)
+{
+  CH_assert((a_deflateLevel >= 0) && (a_deflateLevel <= 9));
+  CH_assert(a_chunkSize > 0);
+  s_deflateLevel = a_deflateLevel;
+  s_shuffle      = a_shuffle;
+  s_chunkSize    = a_chunkSize;
+}
+
+hid_t HDF5Handle::dataCreateProps(hsize_t a_size)
+{
+  //chunk dimensions have to be positive
+  if ((s_deflateLevel == 0) || (a_size == 0))
+    {
+      return H5P_DEFAULT;
+    }
+  hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+  hsize_t chunk[1];
+  chunk[0] = (a_size < (hsize_t)s_chunkSize) ? a_size : (hsize_t)s_chunkSize;
+  H5Pset_chunk(dcpl, 1, chunk);
+  if (s_shuffle)
+    {
+      H5Pset_shuffle(dcpl);
+    }
+  H5Pset_deflate(dcpl, s_deflateLevel);
+  return dcpl;
+}
 
 extern "C"
 {
@@ -550,7 +596,7 @@ void HDF5Handle::initialize()
   initialized = true;
 }
 
-HDF5Handle::HDF5Handle(): m_isOpen(false)
+HDF5Handle::HDF5Handle(): m_isOpen(false), m_floatOutput(false)
 {
   if (!initialized) initialize();
 }
@@ -561,7 +607,8 @@ HDF5Handle::HDF5Handle(
         const char *a_globalGroupName)
             :
         m_isOpen(false),
-        m_level(-1)
+        m_level(-1),
+        m_floatOutput(false)
 {
   int err = open(a_filename, a_mode, a_globalGroupName);
   if (err < 0 )
@@ -611,7 +658,22 @@ int HDF5Handle::open(
 #if ( H5_VERS_MAJOR == 1 && H5_VERS_MINOR <= 2 )
       H5Pset_mpi(file_access,  Chombo_MPI::comm, MPI_INFO_NULL);
 #else
-      H5Pset_fapl_mpio(file_access,  Chombo_MPI::comm, MPI_INFO_NULL);
+      if (s_numWriters > 0)
+        {
+          //two-phase collective buffering onto s_numWriters aggregators
+          MPI_Info info;
+          MPI_Info_create(&info);
+          char numWriters[32];
+          sprintf(numWriters, "%d", s_numWriters);
+          MPI_Info_set(info, (char*)"cb_nodes", numWriters);
+          MPI_Info_set(info, (char*)"romio_cb_write", (char*)"enable");
+          H5Pset_fapl_mpio(file_access,  Chombo_MPI::comm, info);
+          MPI_Info_free(&info);
+        }
+      else
+        {
+          H5Pset_fapl_mpio(file_access,  Chombo_MPI::comm, MPI_INFO_NULL);
+        }
 #endif
 #else
       file_access = H5P_DEFAULT;
@@ -810,6 +872,16 @@ const hid_t& HDF5Handle::groupID() const
   return m_currentGroupID;
 }
 
+void HDF5Handle::setFloatOutput(bool a_floatOutput)
+{
+  m_floatOutput = a_floatOutput;
+}
+
+bool HDF5Handle::floatOutput() const
+{
+  return m_floatOutput;
+}
+
 //=====================================================================================
   /// writes the current attribute list to the current group in 'file'
 int HDF5HeaderData::writeToFile(HDF5Handle& file) const
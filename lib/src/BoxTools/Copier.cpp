@@ -17,6 +17,7 @@
 #include "SPMD.H"
 #include "CH_Timer.H"
 #include "memtrack.H"
+#include "SharedMemoryExchange.H"
 #include "parstream.H"
 
 #include <vector>
@@ -40,8 +41,66 @@ void CopierBuffer::clear()
   m_sendcapacity = 0;
   m_reccapacity = 0;
   m_ncomps = 0;
+  if (m_sharedOffset >= 0 && m_sharedGeneration == SharedMemoryExchange::generation())
+    {
+      SharedMemoryExchange::release(m_sharedOffset);
+    }
+  m_sharedOffset = -1;
+  m_sharedCapacity = 0;
+  m_type = NULL;
+  freePersistentRequests();
 }
 
+void CopierBuffer::freePersistentRequests() const
+{
+#ifdef CH_MPI
+  // a Copier may outlive MPI, its requests went with it
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (!finalized)
+    {
+      for (unsigned int i = 0; i < m_persistentSends.size(); i++)
+        {
+          MPI_Request_free(&(m_persistentSends[i]));
+        }
+      for (unsigned int i = 0; i < m_persistentReceives.size(); i++)
+        {
+          MPI_Request_free(&(m_persistentReceives[i]));
+        }
+    }
+  m_persistentSends.resize(0);
+  m_persistentReceives.resize(0);
+#endif
+}
+
+#ifdef CH_MPI
+void CopierBuffer::postSend(bool a_persistent, void* a_buffer, int a_count, MPI_Datatype a_type,
+                            int a_dest, int a_tag, MPI_Request* a_request)
+{
+  if (a_persistent)
+    {
+      MPI_Send_init(a_buffer, a_count, a_type, a_dest, a_tag, Chombo_MPI::comm, a_request);
+    }
+  else
+    {
+      MPI_Isend(a_buffer, a_count, a_type, a_dest, a_tag, Chombo_MPI::comm, a_request);
+    }
+}
+
+void CopierBuffer::postReceive(bool a_persistent, void* a_buffer, int a_count, MPI_Datatype a_type,
+                               int a_source, int a_tag, MPI_Request* a_request)
+{
+  if (a_persistent)
+    {
+      MPI_Recv_init(a_buffer, a_count, a_type, a_source, a_tag, Chombo_MPI::comm, a_request);
+    }
+  else
+    {
+      MPI_Irecv(a_buffer, a_count, a_type, a_source, a_tag, Chombo_MPI::comm, a_request);
+    }
+}
+#endif
+
 Copier::Copier(const DisjointBoxLayout& a_level,
                const BoxLayout& a_dest,
                bool a_exchange,
@@ -8,9 +8,12 @@
  */
 #endif
 
+#include <cstring>
 #include <iostream>
 #include <list>
+#include <map>
 #include <set>
+#include <utility>
 using std::cout;
 
 #include "parstream.H"
@@ -20,6 +23,7 @@ using std::cout;
 #include "SPMD.H"
 #include "LoadBalance.H"
 #include "LayoutIterator.H"
+#include "BoxIterator.H"
 #include "CH_Timer.H"
 
 // Write a text file per call to LoadBalance()
@@ -57,6 +61,36 @@ public:
   int grid_index; //link to Grids[]
 };
 
+// Local class definition (needed to sort chunk-rank overlaps, largest first)
+class ChunkOverlap
+{
+public:
+  ChunkOverlap():overlap(0) ,chunk(0) ,proc(0)
+  {
+  }
+
+  bool operator < (const ChunkOverlap& rhs) const
+  {
+    if (overlap != rhs.overlap) return overlap > rhs.overlap;
+    if (chunk   != rhs.chunk)   return chunk < rhs.chunk;
+    return proc < rhs.proc;
+  }
+
+  long long overlap; //cells of the chunk over coarse cells owned by proc
+  int chunk;
+  int proc;
+};
+
+// Local class definition (needed for maps keyed by IntVect)
+class IntVectLess
+{
+public:
+  bool operator () (const IntVect& a, const IntVect& b) const
+  {
+    return a.lexLT(b);
+  }
+};
+
 // Code:
 
 ///
@@ -501,6 +535,7 @@ int LoadBalance(Vector<int>&             a_procAssignments,
       //    <<" swaps: "<<swapcount<<std::endl;
     }
 #endif
+  mapBinsToNodes(a_procAssignments, a_LBnumProc);
   return status;
 }
 
@@ -811,6 +846,260 @@ int LoadBalance(Vector<int>& a_procAssignments,
 }
 
 
+///
+// Cuts a space-filling-curve ordered level into contiguous chunks of
+// equal load and, if the coarser level is given, hands each chunk to
+// the rank that owns most of the coarse cells under it.
+///
+int SFCLoadBalance(Vector<int>&             a_procAssignments,
+                   const Vector<long long>& a_computeLoads,
+                   const Vector<Box>&       a_boxes,
+                   const Vector<Box>&       a_parentBoxes,
+                   const Vector<int>&       a_parentProcs,
+                   const int                a_refRatio,
+                   const int                a_LBnumProc)
+{
+  CH_TIME("SFCLoadBalance");
+  const int Nboxes = a_boxes.size();
+  CH_assert(a_computeLoads.size() == Nboxes);
+  CH_assert(a_parentBoxes.size() == a_parentProcs.size());
+  CH_assert(a_LBnumProc > 0);
+
+  a_procAssignments.resize(0);
+  a_procAssignments.resize(Nboxes, 0);
+  if (a_LBnumProc == 1 || Nboxes == 0)
+    {
+      return 0;
+    }
+
+  double totalLoad = 0;
+  for (int ibox = 0; ibox < Nboxes; ++ibox)
+    {
+      CH_assert(a_computeLoads[ibox] >= 0);
+      totalLoad += a_computeLoads[ibox];
+    }
+  if (totalLoad <= 0)
+    {
+      return LoadBalance(a_procAssignments, a_boxes, a_LBnumProc);
+    }
+
+  // chunk k holds the load in [k, k+1)*totalLoad/a_LBnumProc of the curve.
+  // Cutting at the midpoint of each box's load keeps the chunks contiguous
+  // and each within half a box of the goal.
+  Vector<int> chunk(Nboxes);
+  double prefix = 0;
+  for (int ibox = 0; ibox < Nboxes; ++ibox)
+    {
+      double mid = prefix + 0.5*a_computeLoads[ibox];
+      chunk[ibox] = Min(a_LBnumProc-1, int(mid*a_LBnumProc/totalLoad));
+      prefix += a_computeLoads[ibox];
+    }
+
+  if (a_parentBoxes.size() == 0)
+    {
+      a_procAssignments = chunk;
+      mapBinsToNodes(a_procAssignments, a_LBnumProc);
+      return 0;
+    }
+
+  // bucket the coarse boxes by their small end so that the ones under a
+  // fine box can be found without looking at all of them
+  CH_assert(a_refRatio > 0);
+  int bucketSize = 1;
+  for (int ip = 0; ip < a_parentBoxes.size(); ++ip)
+    {
+      for (int idir = 0; idir < SpaceDim; ++idir)
+        {
+          bucketSize = Max(bucketSize, a_parentBoxes[ip].size(idir));
+        }
+    }
+  std::map<IntVect, Vector<int>, IntVectLess> buckets;
+  for (int ip = 0; ip < a_parentBoxes.size(); ++ip)
+    {
+      buckets[coarsen(a_parentBoxes[ip].smallEnd(), bucketSize)].push_back(ip);
+    }
+
+  // cells of each chunk that sit over the cells of each coarse rank
+  Vector<std::map<int, long long> > overlap(a_LBnumProc);
+  for (int ibox = 0; ibox < Nboxes; ++ibox)
+    {
+      Box coarBox = coarsen(a_boxes[ibox], a_refRatio);
+      Box bucketBox(coarsen(coarBox.smallEnd(), bucketSize) - IntVect::Unit,
+                    coarsen(coarBox.bigEnd(),   bucketSize));
+      long long fineCells = a_boxes[ibox].numPts();
+      long long coarCells = coarBox.numPts();
+      for (BoxIterator bit(bucketBox); bit.ok(); ++bit)
+        {
+          std::map<IntVect, Vector<int>, IntVectLess>::const_iterator it = buckets.find(bit());
+          if (it == buckets.end()) continue;
+          const Vector<int>& parents = it->second;
+          for (int i = 0; i < parents.size(); ++i)
+            {
+              Box inter = coarBox & a_parentBoxes[parents[i]];
+              if (!inter.isEmpty())
+                {
+                  overlap[chunk[ibox]][a_parentProcs[parents[i]]] +=
+                    (inter.numPts()*fineCells)/coarCells;
+                }
+            }
+        }
+    }
+
+  // greedy matching, largest overlap first
+  Vector<ChunkOverlap> pairs;
+  for (int ichunk = 0; ichunk < a_LBnumProc; ++ichunk)
+    {
+      std::map<int, long long>::const_iterator it;
+      for (it = overlap[ichunk].begin(); it != overlap[ichunk].end(); ++it)
+        {
+          if (it->first < 0 || it->first >= a_LBnumProc) continue;
+          ChunkOverlap pair;
+          pair.overlap = it->second;
+          pair.chunk   = ichunk;
+          pair.proc    = it->first;
+          pairs.push_back(pair);
+        }
+    }
+  pairs.sort();
+
+  Vector<int> chunkProc(a_LBnumProc, -1);
+  Vector<int> procUsed(a_LBnumProc, 0);
+  for (int ipair = 0; ipair < pairs.size(); ++ipair)
+    {
+      const ChunkOverlap& pair = pairs[ipair];
+      if (chunkProc[pair.chunk] < 0 && !procUsed[pair.proc])
+        {
+          chunkProc[pair.chunk] = pair.proc;
+          procUsed[pair.proc] = 1;
+        }
+    }
+  // chunks with nothing underneath take the unused ranks in order,
+  // node by node if the topology is known
+  Vector<int> rankOrder(a_LBnumProc);
+  for (int iproc = 0; iproc < a_LBnumProc; ++iproc)
+    {
+      rankOrder[iproc] = iproc;
+    }
+  mapBinsToNodes(rankOrder, a_LBnumProc);
+  int nextProc = 0;
+  for (int ichunk = 0; ichunk < a_LBnumProc; ++ichunk)
+    {
+      if (chunkProc[ichunk] < 0)
+        {
+          while (procUsed[rankOrder[nextProc]]) nextProc++;
+          chunkProc[ichunk] = rankOrder[nextProc];
+          procUsed[rankOrder[nextProc]] = 1;
+        }
+    }
+
+  for (int ibox = 0; ibox < Nboxes; ++ibox)
+    {
+      a_procAssignments[ibox] = chunkProc[chunk[ibox]];
+    }
+  return 0;
+}
+
+// node (or socket) of each rank, set by setRankNodes()
+static Vector<int> s_rankNodes;
+
+void setRankNodes(const Vector<int>& a_rankNodes)
+{
+  s_rankNodes = a_rankNodes;
+}
+
+const Vector<int>& getRankNodes()
+{
+  return s_rankNodes;
+}
+
+///
+// Every rank finds the lowest rank on its node; those are gathered and
+// the nodes numbered in order of their lowest rank.
+///
+int detectRankNodes(Vector<int>& a_rankNodes, int a_ranksPerSocket)
+{
+  CH_TIME("detectRankNodes");
+  const int nproc = numProc();
+  Vector<int> leaders(nproc, 0);
+#ifdef CH_MPI
+  int leader = procID();
+#if MPI_VERSION >= 3
+  MPI_Comm nodeComm;
+  MPI_Comm_split_type(Chombo_MPI::comm, MPI_COMM_TYPE_SHARED, procID(),
+                      MPI_INFO_NULL, &nodeComm);
+  int myRank = procID();
+  MPI_Allreduce(&myRank, &leader, 1, MPI_INT, MPI_MIN, nodeComm);
+  MPI_Comm_free(&nodeComm);
+#else
+  char name[MPI_MAX_PROCESSOR_NAME];
+  for (int i = 0; i < MPI_MAX_PROCESSOR_NAME; ++i) name[i] = 0;
+  int length;
+  MPI_Get_processor_name(name, &length);
+  Vector<char> allNames(nproc*MPI_MAX_PROCESSOR_NAME);
+  MPI_Allgather(name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR,
+                &(allNames[0]), MPI_MAX_PROCESSOR_NAME, MPI_CHAR, Chombo_MPI::comm);
+  for (int iproc = 0; iproc < nproc; ++iproc)
+    {
+      if (strncmp(name, &(allNames[iproc*MPI_MAX_PROCESSOR_NAME]), MPI_MAX_PROCESSOR_NAME) == 0)
+        {
+          leader = iproc;
+          break;
+        }
+    }
+#endif
+  MPI_Allgather(&leader, 1, MPI_INT, &(leaders[0]), 1, MPI_INT, Chombo_MPI::comm);
+#endif
+
+  // groups are (node, socket) pairs with the sockets counted within the
+  // node, numbered node-major so the sockets of a node stay adjacent
+  std::map<int, int> nodeCount;
+  std::map<std::pair<int, int>, int> groups;
+  Vector<std::pair<int, int> > rankGroup(nproc);
+  for (int iproc = 0; iproc < nproc; ++iproc)
+    {
+      int local = nodeCount[leaders[iproc]]++;
+      int socket = (a_ranksPerSocket > 0) ? local/a_ranksPerSocket : 0;
+      rankGroup[iproc] = std::pair<int, int>(leaders[iproc], socket);
+      groups[rankGroup[iproc]] = 0;
+    }
+  int numGroups = 0;
+  std::map<std::pair<int, int>, int>::iterator it;
+  for (it = groups.begin(); it != groups.end(); ++it)
+    {
+      it->second = numGroups++;
+    }
+  a_rankNodes.resize(nproc);
+  for (int iproc = 0; iproc < nproc; ++iproc)
+    {
+      a_rankNodes[iproc] = groups[rankGroup[iproc]];
+    }
+  return numGroups;
+}
+
+///
+// Bin k goes to the k-th rank of the ranks sorted by node, then by rank.
+///
+void mapBinsToNodes(Vector<int>& a_procAssignments,
+                    const int    a_LBnumProc)
+{
+  if (s_rankNodes.size() != a_LBnumProc || a_LBnumProc == 1)
+    {
+      return;
+    }
+  Vector<std::pair<int, int> > ranks(a_LBnumProc);
+  for (int iproc = 0; iproc < a_LBnumProc; ++iproc)
+    {
+      ranks[iproc] = std::pair<int, int>(s_rankNodes[iproc], iproc);
+    }
+  ranks.sort();
+  for (int ibox = 0; ibox < a_procAssignments.size(); ++ibox)
+    {
+      int bin = a_procAssignments[ibox];
+      CH_assert(bin >= 0 && bin < a_LBnumProc);
+      a_procAssignments[ibox] = ranks[bin].second;
+    }
+}
+
 ////////////////////////////////////////////////////////////////
 //                utility functions                           //
 ////////////////////////////////////////////////////////////////
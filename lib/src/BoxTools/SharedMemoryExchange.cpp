@@ -0,0 +1,132 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "SharedMemoryExchange.H"
+#include "MayDay.H"
+#include "parstream.H"
+#include "CH_Timer.H"
+#include "NamespaceHeader.H"
+
+bool                         SharedMemoryExchange::s_isDefined   = false;
+int                          SharedMemoryExchange::s_generation  = 0;
+size_t                       SharedMemoryExchange::s_segmentSize = 0;
+Vector<char*>                SharedMemoryExchange::s_segments;
+std::map<long long, size_t>  SharedMemoryExchange::s_blocks;
+#ifdef CH_MPI
+MPI_Win                      SharedMemoryExchange::s_window   = MPI_WIN_NULL;
+MPI_Comm                     SharedMemoryExchange::s_nodeComm = MPI_COMM_NULL;
+#endif
+
+// blocks start on this boundary so that every FAB packs aligned
+static const size_t s_blockAlign = 64;
+
+void SharedMemoryExchange::define(size_t a_bytesPerRank)
+{
+  CH_TIME("SharedMemoryExchange::define");
+  clear();
+#if defined(CH_MPI) && (MPI_VERSION >= 3)
+  s_segmentSize = a_bytesPerRank - a_bytesPerRank%s_blockAlign;
+  MPI_Comm_split_type(Chombo_MPI::comm, MPI_COMM_TYPE_SHARED, procID(),
+                      MPI_INFO_NULL, &s_nodeComm);
+
+  //each segment in the memory of its own rank
+  MPI_Info info;
+  MPI_Info_create(&info);
+  MPI_Info_set(info, (char*)"alloc_shared_noncontig", (char*)"true");
+  char* myBase;
+  int result = MPI_Win_allocate_shared(s_segmentSize, 1, info, s_nodeComm,
+                                       &myBase, &s_window);
+  MPI_Info_free(&info);
+  if (result != MPI_SUCCESS)
+    {
+      MayDay::Error("SharedMemoryExchange: MPI_Win_allocate_shared failed");
+    }
+
+  int nodeSize;
+  MPI_Comm_size(s_nodeComm, &nodeSize);
+  Vector<int> nodeProcs(nodeSize);
+  int myProc = procID();
+  MPI_Allgather(&myProc, 1, MPI_INT, &(nodeProcs[0]), 1, MPI_INT, s_nodeComm);
+
+  s_segments.resize(0);
+  s_segments.resize(numProc(), NULL);
+  for (int irank = 0; irank < nodeSize; irank++)
+    {
+      MPI_Aint size;
+      int      dispUnit;
+      char*    base;
+      MPI_Win_shared_query(s_window, irank, &size, &dispUnit, &base);
+      s_segments[nodeProcs[irank]] = base;
+    }
+
+  //one passive epoch for the life of the window, ordering is by messages and sync()
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, s_window);
+  s_isDefined = true;
+  s_generation++;
+#endif
+}
+
+void SharedMemoryExchange::clear()
+{
+#if defined(CH_MPI) && (MPI_VERSION >= 3)
+  if (s_isDefined)
+    {
+      MPI_Win_unlock_all(s_window);
+      MPI_Win_free(&s_window);
+      MPI_Comm_free(&s_nodeComm);
+    }
+#endif
+  s_isDefined = false;
+  s_generation++;
+  s_segmentSize = 0;
+  s_segments.resize(0);
+  s_blocks.clear();
+}
+
+long long SharedMemoryExchange::allocate(size_t a_bytes)
+{
+  if (!s_isDefined) return -1;
+  size_t bytes = a_bytes + (s_blockAlign - a_bytes%s_blockAlign)%s_blockAlign;
+
+  //first fit between the blocks in use
+  long long start = 0;
+  std::map<long long, size_t>::const_iterator it;
+  for (it = s_blocks.begin(); it != s_blocks.end(); ++it)
+    {
+      if (it->first - start >= (long long)bytes) break;
+      start = it->first + it->second;
+    }
+  if (start + (long long)bytes > (long long)s_segmentSize)
+    {
+      return -1;
+    }
+  s_blocks[start] = bytes;
+  return start;
+}
+
+void SharedMemoryExchange::release(long long a_offset)
+{
+  if (!s_isDefined) return;
+  std::map<long long, size_t>::iterator it = s_blocks.find(a_offset);
+  CH_assert(it != s_blocks.end());
+  s_blocks.erase(it);
+}
+
+void SharedMemoryExchange::sync()
+{
+#if defined(CH_MPI) && (MPI_VERSION >= 3)
+  if (s_isDefined)
+    {
+      MPI_Win_sync(s_window);
+    }
+#endif
+}
+
+#include "NamespaceFooter.H"
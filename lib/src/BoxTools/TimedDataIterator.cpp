@@ -83,7 +83,7 @@ void TimedDataIterator::mergeTime()
 #ifdef CH_MPI
   int count = m_time.size();
   Vector<unsigned long long> tmp(count);
-  MPI_Allreduce(&(m_time[0]),&(tmp[0]), count, MPI_LONG_LONG_INT, MPI_SUM, Chombo_MPI::comm);
+  MPI_Allreduce(&(m_time[0]),&(tmp[0]), count, MPI_UNSIGNED_LONG_LONG, MPI_SUM, Chombo_MPI::comm);
   m_time = tmp;
 #endif
 }
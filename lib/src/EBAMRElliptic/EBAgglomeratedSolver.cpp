@@ -0,0 +1,653 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <algorithm>
+
+#include "EBAgglomeratedSolver.H"
+#include "EBEllipticLoadBalance.H"
+#include "VoFIterator.H"
+#include "BoxIterator.H"
+#include "SPMD.H"
+#include "CH_Timer.H"
+#include "parstream.H"
+#include "NamespaceHeader.H"
+
+/*****/
+//color of a_iv in direction a_idir for periods a_period
+static inline int
+agglomColor(const IntVect& a_iv, const Box& a_domainBox,
+            const IntVect& a_period, int a_idir)
+{
+  int shifted = a_iv[a_idir] - a_domainBox.smallEnd(a_idir);
+  return ((shifted % a_period[a_idir]) + a_period[a_idir]) % a_period[a_idir];
+}
+/*****/
+//the cell of color a_color within a_radius of a_iv.  false if there is
+//none inside the domain.  the periods make it unique.
+static bool
+agglomColumnCell(IntVect&             a_colIV,
+                 const IntVect&       a_iv,
+                 const IntVect&       a_color,
+                 const IntVect&       a_period,
+                 int                  a_radius,
+                 const ProblemDomain& a_domain)
+{
+  const Box& domainBox = a_domain.domainBox();
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      int period = a_period[idir];
+      int delta  = (a_color[idir] - agglomColor(a_iv, domainBox, a_period, idir) + period) % period;
+      int offset;
+      if (delta <= a_radius)
+        {
+          offset = delta;
+        }
+      else if (delta - period >= -a_radius)
+        {
+          offset = delta - period;
+        }
+      else
+        {
+          return false;
+        }
+      int icell = a_iv[idir] + offset;
+      int lo = domainBox.smallEnd(idir);
+      int hi = domainBox.bigEnd(idir);
+      if ((icell < lo) || (icell > hi))
+        {
+          if (!a_domain.isPeriodic(idir)) return false;
+          int ncell = hi - lo + 1;
+          icell = lo + (((icell - lo) % ncell) + ncell) % ncell;
+        }
+      a_colIV[idir] = icell;
+    }
+  return true;
+}
+/*****/
+EBAgglomeratedSolver::EBAgglomeratedSolver()
+{
+  m_operator       = NULL;
+  m_fallback       = NULL;
+  m_homogeneous    = true;
+  m_isBuilt        = false;
+  m_checkOperator  = false;
+  m_isAgglomerated = false;
+  m_numBuilds      = 0;
+  m_radius         = 2;
+  m_maxBandEntries = 16777216;
+  m_verbosity      = 0;
+  m_maxVoFs        = 1;
+  m_nComp          = 0;
+  m_rootRank       = 0;
+  m_numUnknowns    = 0;
+  m_numLocal       = 0;
+  m_lowerBand      = 0;
+  m_upperBand      = 0;
+}
+/*****/
+EBAgglomeratedSolver::~EBAgglomeratedSolver()
+{
+}
+/*****/
+void EBAgglomeratedSolver::setHomogeneous(bool a_homogeneous)
+{
+  if (!a_homogeneous)
+    {
+      MayDay::Error("EBAgglomeratedSolver only solves homogeneous problems");
+    }
+  m_homogeneous = a_homogeneous;
+  if (m_fallback != NULL)
+    {
+      m_fallback->setHomogeneous(a_homogeneous);
+    }
+}
+/*****/
+void EBAgglomeratedSolver::define(LinearOp<LevelData<EBCellFAB> >* a_operator,
+                                  bool                             a_homogeneous)
+{
+  if (!a_homogeneous)
+    {
+      MayDay::Error("EBAgglomeratedSolver only solves homogeneous problems");
+    }
+  m_operator      = a_operator;
+  m_homogeneous   = a_homogeneous;
+  m_checkOperator = true;
+  if (m_fallback != NULL)
+    {
+      m_fallback->define(a_operator, a_homogeneous);
+    }
+}
+/*****/
+void EBAgglomeratedSolver::setConvergenceMetrics(Real a_metric,
+                                                 Real a_tolerance)
+{
+  if (m_fallback != NULL)
+    {
+      m_fallback->setConvergenceMetrics(a_metric, a_tolerance);
+    }
+}
+/*****/
+void EBAgglomeratedSolver::setFallback(LinearSolver<LevelData<EBCellFAB> >* a_fallback)
+{
+  m_fallback = a_fallback;
+  if ((m_fallback != NULL) && (m_operator != NULL))
+    {
+      m_fallback->define(m_operator, m_homogeneous);
+    }
+}
+/*****/
+void EBAgglomeratedSolver::setStencilRadius(int a_radius)
+{
+  CH_assert(a_radius >= 1);
+  m_radius  = a_radius;
+  m_isBuilt = false;
+}
+/*****/
+void EBAgglomeratedSolver::setMaxBandEntries(long long a_maxBandEntries)
+{
+  m_maxBandEntries = a_maxBandEntries;
+  m_isBuilt        = false;
+}
+/*****/
+long EBAgglomeratedSolver::getKey(const IntVect& a_iv, int a_cellIndex, int a_comp) const
+{
+  long cellKey = m_domainBox.index(a_iv);
+  return (cellKey*m_maxVoFs + a_cellIndex)*m_nComp + a_comp;
+}
+/*****/
+void EBAgglomeratedSolver::buildMatrix(const LevelData<EBCellFAB>& a_template)
+{
+  CH_TIME("EBAgglomeratedSolver::buildMatrix");
+  CH_assert(m_operator != NULL);
+  const DisjointBoxLayout& grids  = a_template.disjointBoxLayout();
+  const ProblemDomain&     domain = grids.physDomain();
+  m_domainBox = domain.domainBox();
+  m_nComp     = a_template.nComp();
+  m_rootRank  = getAgglomerationRank(grids);
+  m_grids     = grids;
+
+  //the local unknowns and the most vofs in any cell
+  int maxVoFs = 1;
+  m_numLocal  = 0;
+  m_vofs.define(grids);
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      const EBISBox& ebisBox = a_template[dit()].getEBISBox();
+      IntVectSet ivs(grids.get(dit()));
+      VoFIterator vofit(ivs, ebisBox.getEBGraph());
+      m_vofs[dit()] = vofit.getVector();
+      const Vector<VolIndex>& vofs = m_vofs[dit()];
+      for (int ivof = 0; ivof < vofs.size(); ivof++)
+        {
+          maxVoFs = Max(maxVoFs, vofs[ivof].cellIndex() + 1);
+        }
+      m_numLocal += vofs.size()*m_nComp;
+    }
+  m_maxVoFs = maxVoFs;
+#ifdef CH_MPI
+  MPI_Allreduce(&maxVoFs, &m_maxVoFs, 1, MPI_INT, MPI_MAX, Chombo_MPI::comm);
+#endif
+
+  //cells of one color are far enough apart that a probe response
+  //comes from a single cell.  periodic directions need a period that
+  //divides the domain so the coloring survives the wrap.
+  IntVect period;
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      int ncell = m_domainBox.size(idir);
+      period[idir] = 2*m_radius + 1;
+      if (domain.isPeriodic(idir))
+        {
+          period[idir] = ncell;
+          for (int iper = 2*m_radius + 1; iper < ncell; iper++)
+            {
+              if (ncell%iper == 0)
+                {
+                  period[idir] = iper;
+                  break;
+                }
+            }
+        }
+    }
+  Box colorBox(IntVect::Zero, period - IntVect::Unit);
+
+  Vector<long> rowKeys;
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      const Vector<VolIndex>& vofs = m_vofs[dit()];
+      for (int ivof = 0; ivof < vofs.size(); ivof++)
+        {
+          for (int icomp = 0; icomp < m_nComp; icomp++)
+            {
+              rowKeys.push_back(getKey(vofs[ivof].gridIndex(), vofs[ivof].cellIndex(), icomp));
+            }
+        }
+    }
+
+  //probe the operator.  entries are (local row, column key, value)
+  Vector<long> entRow, entCol;
+  Vector<Real> entVal;
+  LevelData<EBCellFAB> probe, response;
+  m_operator->create(probe,    a_template);
+  m_operator->create(response, a_template);
+  for (BoxIterator colit(colorBox); colit.ok(); ++colit)
+    {
+      const IntVect& color = colit();
+      for (int icell = 0; icell < m_maxVoFs; icell++)
+        {
+          for (int icomp = 0; icomp < m_nComp; icomp++)
+            {
+              m_operator->setToZero(probe);
+              for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+                {
+                  const Vector<VolIndex>& vofs = m_vofs[dit()];
+                  for (int ivof = 0; ivof < vofs.size(); ivof++)
+                    {
+                      const VolIndex& vof = vofs[ivof];
+                      if (vof.cellIndex() != icell) continue;
+                      bool hasColor = true;
+                      for (int idir = 0; idir < SpaceDim; idir++)
+                        {
+                          hasColor = hasColor &&
+                            (agglomColor(vof.gridIndex(), m_domainBox, period, idir) == color[idir]);
+                        }
+                      if (hasColor)
+                        {
+                          probe[dit()](vof, icomp) = 1.0;
+                        }
+                    }
+                }
+
+              m_operator->applyOp(response, probe, true);
+
+              long irow = 0;
+              for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+                {
+                  const Vector<VolIndex>& vofs = m_vofs[dit()];
+                  for (int ivof = 0; ivof < vofs.size(); ivof++)
+                    {
+                      const VolIndex& vof = vofs[ivof];
+                      IntVect colIV;
+                      bool hasCol = agglomColumnCell(colIV, vof.gridIndex(), color,
+                                                     period, m_radius, domain);
+                      for (int jcomp = 0; jcomp < m_nComp; jcomp++, irow++)
+                        {
+                          Real value = response[dit()](vof, jcomp);
+                          if (value == 0.0) continue;
+                          if (!hasCol)
+                            {
+                              MayDay::Error("EBAgglomeratedSolver: operator stencil is wider than the stencil radius");
+                            }
+                          entRow.push_back(irow);
+                          entCol.push_back(getKey(colIV, icell, icomp));
+                          entVal.push_back(value);
+                        }
+                    }
+                }
+            }
+        }
+    }
+  m_operator->clear(probe);
+  m_operator->clear(response);
+
+  Vector< Vector<long> > allRowKeys, allEntRow, allEntCol;
+  Vector< Vector<Real> > allEntVal;
+  gather(allRowKeys, rowKeys, m_rootRank);
+  gather(allEntRow,  entRow,  m_rootRank);
+  gather(allEntCol,  entCol,  m_rootRank);
+  gather(allEntVal,  entVal,  m_rootRank);
+
+  int agglomerated = 0;
+  long numUnknowns = 0;
+  if (procID() == m_rootRank)
+    {
+      //unknowns are numbered in key order, which keeps the band narrow
+      std::vector<long> sortedKeys;
+      m_rankCount.resize(allRowKeys.size());
+      m_rankDispl.resize(allRowKeys.size());
+      int displ = 0;
+      for (int irank = 0; irank < allRowKeys.size(); irank++)
+        {
+          m_rankCount[irank] = allRowKeys[irank].size();
+          m_rankDispl[irank] = displ;
+          displ += m_rankCount[irank];
+          for (int ikey = 0; ikey < allRowKeys[irank].size(); ikey++)
+            {
+              sortedKeys.push_back(allRowKeys[irank][ikey]);
+            }
+        }
+      std::sort(sortedKeys.begin(), sortedKeys.end());
+      numUnknowns = sortedKeys.size();
+
+      m_gatherIndex.resize(numUnknowns);
+      for (int irank = 0; irank < allRowKeys.size(); irank++)
+        {
+          for (int ikey = 0; ikey < allRowKeys[irank].size(); ikey++)
+            {
+              m_gatherIndex[m_rankDispl[irank] + ikey] =
+                std::lower_bound(sortedKeys.begin(), sortedKeys.end(), allRowKeys[irank][ikey])
+                - sortedKeys.begin();
+            }
+        }
+
+      Vector<long> rows, cols;
+      Vector<Real> vals;
+      long lowerBand = 0, upperBand = 0;
+      for (int irank = 0; irank < allEntRow.size(); irank++)
+        {
+          for (int ient = 0; ient < allEntRow[irank].size(); ient++)
+            {
+              long row = m_gatherIndex[m_rankDispl[irank] + allEntRow[irank][ient]];
+              std::vector<long>::iterator colit =
+                std::lower_bound(sortedKeys.begin(), sortedKeys.end(), allEntCol[irank][ient]);
+              if ((colit == sortedKeys.end()) || (*colit != allEntCol[irank][ient]))
+                {
+                  MayDay::Error("EBAgglomeratedSolver: probe response from a cell that is not an unknown; check the stencil radius");
+                }
+              long col = colit - sortedKeys.begin();
+              lowerBand = Max(lowerBand, row - col);
+              upperBand = Max(upperBand, col - row);
+              rows.push_back(row);
+              cols.push_back(col);
+              vals.push_back(allEntVal[irank][ient]);
+            }
+        }
+      m_lowerBand = lowerBand;
+      m_upperBand = upperBand;
+
+      long long bandEntries = (long long)numUnknowns*(2*lowerBand + upperBand + 1);
+      if (bandEntries <= m_maxBandEntries)
+        {
+          agglomerated = factor(rows, cols, vals) ? 1 : 0;
+        }
+      if (m_verbosity > 0)
+        {
+          pout() << "EBAgglomeratedSolver: " << numUnknowns << " unknowns on rank "
+                 << m_rootRank << ", bandwidth " << lowerBand << "/" << upperBand
+                 << (agglomerated ? "" : ", using the fallback solver") << endl;
+        }
+      if (!agglomerated)
+        {
+          m_band.resize(0);
+          m_pivot.resize(0);
+        }
+    }
+  broadcast(agglomerated, m_rootRank);
+  m_numUnknowns    = m_numLocal;
+#ifdef CH_MPI
+  long localUnknowns = m_numLocal;
+  MPI_Allreduce(&localUnknowns, &m_numUnknowns, 1, MPI_LONG, MPI_SUM, Chombo_MPI::comm);
+#endif
+  m_isAgglomerated = (agglomerated == 1);
+  m_isBuilt        = true;
+  m_numBuilds++;
+  getSignature(m_signature, a_template);
+  if (!m_isAgglomerated && (m_fallback == NULL))
+    {
+      MayDay::Error("EBAgglomeratedSolver: bottom problem cannot be agglomerated and there is no fallback solver");
+    }
+}
+/*****/
+void EBAgglomeratedSolver::getSignature(Vector<Real>&               a_signature,
+                                        const LevelData<EBCellFAB>& a_template)
+{
+  CH_TIME("EBAgglomeratedSolver::getSignature");
+  //probe values that depend on the unknown and not on the layout, so
+  //almost any change of the coefficients changes the response
+  LevelData<EBCellFAB> probe, response;
+  m_operator->create(probe,    a_template);
+  m_operator->create(response, a_template);
+  m_operator->setToZero(probe);
+  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+    {
+      const Vector<VolIndex>& vofs = m_vofs[dit()];
+      for (int ivof = 0; ivof < vofs.size(); ivof++)
+        {
+          for (int icomp = 0; icomp < m_nComp; icomp++)
+            {
+              long key = getKey(vofs[ivof].gridIndex(), vofs[ivof].cellIndex(), icomp);
+              probe[dit()](vofs[ivof], icomp) = 1.0 + (Real)((key*7919 + 104729)%1009)/1009.0;
+            }
+        }
+    }
+  m_operator->applyOp(response, probe, true);
+
+  a_signature.resize(m_numLocal);
+  int ival = 0;
+  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+    {
+      const Vector<VolIndex>& vofs = m_vofs[dit()];
+      for (int ivof = 0; ivof < vofs.size(); ivof++)
+        {
+          for (int icomp = 0; icomp < m_nComp; icomp++, ival++)
+            {
+              a_signature[ival] = response[dit()](vofs[ivof], icomp);
+            }
+        }
+    }
+  m_operator->clear(probe);
+  m_operator->clear(response);
+}
+/*****/
+bool EBAgglomeratedSolver::isCurrent(const LevelData<EBCellFAB>& a_template)
+{
+  CH_TIME("EBAgglomeratedSolver::isCurrent");
+  //a new layout, even with the same boxes, means a new matrix
+  if (!(a_template.disjointBoxLayout() == m_grids) || (a_template.nComp() != m_nComp))
+    {
+      return false;
+    }
+  Vector<Real> signature;
+  getSignature(signature, a_template);
+  int same = 1;
+  for (int ival = 0; ival < signature.size(); ival++)
+    {
+      if (signature[ival] != m_signature[ival])
+        {
+          same = 0;
+          break;
+        }
+    }
+#ifdef CH_MPI
+  int localSame = same;
+  MPI_Allreduce(&localSame, &same, 1, MPI_INT, MPI_MIN, Chombo_MPI::comm);
+#endif
+  return (same == 1);
+}
+/*****/
+bool EBAgglomeratedSolver::factor(const Vector<long>& a_rows,
+                                  const Vector<long>& a_cols,
+                                  const Vector<Real>& a_vals)
+{
+  CH_TIME("EBAgglomeratedSolver::factor");
+  //row i holds columns i-kl to i+ku+kl; the extra kl are fill from pivoting
+  long n  = m_gatherIndex.size();
+  long kl = m_lowerBand;
+  long ku = m_upperBand;
+  long w  = 2*kl + ku + 1;
+  m_band.resize(0);
+  m_band.resize(n*w, 0.0);
+  m_pivot.resize(n);
+  Real maxEntry = 0.0;
+  for (int ient = 0; ient < a_rows.size(); ient++)
+    {
+      long i = a_rows[ient];
+      long j = a_cols[ient];
+      m_band[i*w + j - i + kl] += a_vals[ient];
+      maxEntry = Max(maxEntry, Abs(a_vals[ient]));
+    }
+  Real pivotTol = 1.0e-12*maxEntry;
+
+  for (long k = 0; k < n; k++)
+    {
+      long iend = Min(n - 1, k + kl);
+      long jend = Min(n - 1, k + ku + kl);
+      long ipiv = k;
+      Real maxPiv = Abs(m_band[k*w + kl]);
+      for (long i = k + 1; i <= iend; i++)
+        {
+          Real cand = Abs(m_band[i*w + k - i + kl]);
+          if (cand > maxPiv)
+            {
+              maxPiv = cand;
+              ipiv   = i;
+            }
+        }
+      if (maxPiv <= pivotTol) return false;
+      m_pivot[k] = ipiv;
+      if (ipiv != k)
+        {
+          for (long j = k; j <= jend; j++)
+            {
+              Real temp = m_band[k*w + j - k + kl];
+              m_band[k*w + j - k + kl]       = m_band[ipiv*w + j - ipiv + kl];
+              m_band[ipiv*w + j - ipiv + kl] = temp;
+            }
+        }
+      Real diag = m_band[k*w + kl];
+      for (long i = k + 1; i <= iend; i++)
+        {
+          Real& mult = m_band[i*w + k - i + kl];
+          if (mult == 0.0) continue;
+          mult /= diag;
+          for (long j = k + 1; j <= jend; j++)
+            {
+              m_band[i*w + j - i + kl] -= mult*m_band[k*w + j - k + kl];
+            }
+        }
+    }
+  return true;
+}
+/*****/
+void EBAgglomeratedSolver::backSolve(Vector<Real>& a_rhs) const
+{
+  long n  = m_pivot.size();
+  long kl = m_lowerBand;
+  long ku = m_upperBand;
+  long w  = 2*kl + ku + 1;
+  for (long k = 0; k < n; k++)
+    {
+      long ipiv = m_pivot[k];
+      if (ipiv != k)
+        {
+          Real temp    = a_rhs[k];
+          a_rhs[k]     = a_rhs[ipiv];
+          a_rhs[ipiv]  = temp;
+        }
+      long iend = Min(n - 1, k + kl);
+      for (long i = k + 1; i <= iend; i++)
+        {
+          a_rhs[i] -= m_band[i*w + k - i + kl]*a_rhs[k];
+        }
+    }
+  for (long i = n - 1; i >= 0; i--)
+    {
+      long jend = Min(n - 1, i + ku + kl);
+      Real sum = a_rhs[i];
+      for (long j = i + 1; j <= jend; j++)
+        {
+          sum -= m_band[i*w + j - i + kl]*a_rhs[j];
+        }
+      a_rhs[i] = sum/m_band[i*w + kl];
+    }
+}
+/*****/
+void EBAgglomeratedSolver::solve(LevelData<EBCellFAB>&       a_phi,
+                                 const LevelData<EBCellFAB>& a_rhs)
+{
+  CH_TIME("EBAgglomeratedSolver::solve");
+  CH_assert(m_operator != NULL);
+  //phi has the ghost cells the operator needs
+  if (m_isBuilt && m_checkOperator && !isCurrent(a_phi))
+    {
+      m_isBuilt = false;
+    }
+  m_checkOperator = false;
+  if (!m_isBuilt) buildMatrix(a_phi);
+  if (!m_isAgglomerated)
+    {
+      m_fallback->solve(a_phi, a_rhs);
+      return;
+    }
+
+  Vector<Real> local(Max(m_numLocal, 1), 0.0);
+  int ival = 0;
+  for (DataIterator dit = a_rhs.dataIterator(); dit.ok(); ++dit)
+    {
+      const Vector<VolIndex>& vofs = m_vofs[dit()];
+      for (int ivof = 0; ivof < vofs.size(); ivof++)
+        {
+          for (int icomp = 0; icomp < m_nComp; icomp++, ival++)
+            {
+              local[ival] = a_rhs[dit()](vofs[ivof], icomp);
+            }
+        }
+    }
+
+  bool isRoot = (procID() == m_rootRank);
+  Vector<Real> gathered(isRoot ? Max((int)m_gatherIndex.size(), 1) : 1, 0.0);
+#ifdef CH_MPI
+  {
+    CH_TIME("EBAgglomeratedSolver::gather");
+    MPI_Gatherv(&local[0], m_numLocal, MPI_CH_REAL,
+                &gathered[0], isRoot ? &m_rankCount[0] : NULL, isRoot ? &m_rankDispl[0] : NULL,
+                MPI_CH_REAL, m_rootRank, Chombo_MPI::comm);
+  }
+#else
+  for (int ival = 0; ival < m_numLocal; ival++)
+    {
+      gathered[ival] = local[ival];
+    }
+#endif
+
+  if (isRoot)
+    {
+      long n = m_gatherIndex.size();
+      Vector<Real> unknowns(Max(n, 1L), 0.0);
+      for (long ival = 0; ival < n; ival++)
+        {
+          unknowns[m_gatherIndex[ival]] = gathered[ival];
+        }
+      backSolve(unknowns);
+      for (long ival = 0; ival < n; ival++)
+        {
+          gathered[ival] = unknowns[m_gatherIndex[ival]];
+        }
+    }
+
+#ifdef CH_MPI
+  {
+    CH_TIME("EBAgglomeratedSolver::scatter");
+    MPI_Scatterv(&gathered[0], isRoot ? &m_rankCount[0] : NULL, isRoot ? &m_rankDispl[0] : NULL,
+                 MPI_CH_REAL, &local[0], m_numLocal, MPI_CH_REAL,
+                 m_rootRank, Chombo_MPI::comm);
+  }
+#else
+  for (int ival = 0; ival < m_numLocal; ival++)
+    {
+      local[ival] = gathered[ival];
+    }
+#endif
+
+  m_operator->setToZero(a_phi);
+  ival = 0;
+  for (DataIterator dit = a_phi.dataIterator(); dit.ok(); ++dit)
+    {
+      const Vector<VolIndex>& vofs = m_vofs[dit()];
+      for (int ivof = 0; ivof < vofs.size(); ivof++)
+        {
+          for (int icomp = 0; icomp < m_nComp; icomp++, ival++)
+            {
+              a_phi[dit()](vofs[ivof], icomp) = local[ival];
+            }
+        }
+    }
+}
+#include "NamespaceFooter.H"
@@ -29,6 +29,7 @@
 //IntVect EBConductivityOp::s_ivDebug = IntVect(D_DECL(111, 124, 3));
 bool EBConductivityOp::s_turnOffBCs = false; //REALLY needs to default to false
 bool EBConductivityOp::s_forceNoEBCF = false; //REALLY needs to default to false
+bool EBConductivityOp::s_singlePrecisionRelax = false;
 
 //-----------------------------------------------------------------------
 EBConductivityOp::
@@ -88,6 +89,9 @@ EBConductivityOp(const EBLevelGrid &                                  a_eblgFine
     m_ebInterp(),
     m_opEBStencil(),
     m_relCoef(),
+    m_relCoefSingle(),
+    m_bcoefSingle(),
+    m_isAllRegular(),
     m_vofIterIrreg(),
     m_vofIterMulti(),
     m_vofIterDomLo(),
@@ -248,6 +252,9 @@ EBConductivityOp(const EBLevelGrid &                                  a_eblgFine
     m_ebInterp(),
     m_opEBStencil(),
     m_relCoef(),
+    m_relCoefSingle(),
+    m_bcoefSingle(),
+    m_isAllRegular(),
     m_vofIterIrreg(),
     m_vofIterMulti(),
     m_vofIterDomLo(),
@@ -691,6 +698,128 @@ calculateRelaxationCoefficient()
             }
         }
     }
+
+  if (s_singlePrecisionRelax)
+    {
+      defineSingleCoefficients();
+    }
+}
+//-----------------------------------------------------------------------
+void
+EBConductivityOp::
+defineSingleCoefficients()
+{
+  CH_TIME("ebco::defineSingleCoefficients");
+  const DisjointBoxLayout& dbl = m_eblg.getDBL();
+  m_relCoefSingle.define(dbl);
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      m_bcoefSingle[idir].define(dbl);
+    }
+
+  Real dx0 = m_beta/(m_dx*m_dx);
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      const Box& grid = dbl.get(dit());
+      const BaseFab<Real>& regRel = m_relCoef[dit()].getSingleValuedFAB();
+      BaseFab<float>& cellCoef = m_relCoefSingle[dit()];
+      cellCoef.resize(grid, 2);
+      for (BoxIterator bit(grid); bit.ok(); ++bit)
+        {
+          const IntVect& iv = bit();
+          Real acoef;
+          if (!m_acoef.isNull())
+            {
+              acoef = (*m_acoef)[dit()].getSingleValuedFAB()(iv, 0);
+            }
+          else
+            {
+              acoef = 0.5*((*m_acoef0)[dit()].getSingleValuedFAB()(iv, 0) +
+                           (*m_acoef1)[dit()].getSingleValuedFAB()(iv, 0));
+            }
+          cellCoef(iv, 0) = regRel(iv, 0);
+          cellCoef(iv, 1) = m_alpha*acoef;
+        }
+
+      for (int idir = 0; idir < SpaceDim; idir++)
+        {
+          const BaseFab<Real>& regBCo = (*m_bcoef)[dit()][idir].getSingleValuedFAB();
+          Box faceBox = surroundingNodes(grid, idir);
+          BaseFab<float>& faceCoef = m_bcoefSingle[idir][dit()];
+          faceCoef.resize(faceBox, 1);
+          for (BoxIterator bit(faceBox); bit.ok(); ++bit)
+            {
+              faceCoef(bit(), 0) = dx0*regBCo(bit(), 0);
+            }
+        }
+    }
+}
+//-----------------------------------------------------------------------
+//same update as FORT_CONDUCTIVITYGSRB, reading the single precision coefficients
+void
+EBConductivityOp::
+gsrbRegularSingle(BaseFab<Real>&       a_phi,
+                  const BaseFab<Real>& a_rhs,
+                  const Box&           a_region,
+                  const DataIndex&     a_dit,
+                  int                  a_redBlack)
+{
+  const BaseFab<float>& cellCoef = m_relCoefSingle[a_dit];
+  const float* relPtr = cellCoef.dataPtr(0);
+  const float* acoPtr = cellCoef.dataPtr(1);
+
+  const Box& phiBox  = a_phi.box();
+  const Box& rhsBox  = a_rhs.box();
+  const Box& cellBox = cellCoef.box();
+  const float* bcoPtr[SpaceDim];
+  long phiStride[SpaceDim], bcoStride[SpaceDim];
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      bcoPtr[idir] = m_bcoefSingle[idir][a_dit].dataPtr(0);
+      phiStride[idir] = (idir == 0) ? 1 : phiStride[idir-1]*phiBox.size(idir-1);
+      const Box& faceBox = m_bcoefSingle[idir][a_dit].box();
+      bcoStride[idir] = (idir == 0) ? 1 : bcoStride[idir-1]*faceBox.size(idir-1);
+    }
+
+  //one pass per row of the region in the first direction
+  Box rows(a_region);
+  rows.setBig(0, a_region.smallEnd(0));
+  for (BoxIterator bit(rows); bit.ok(); ++bit)
+    {
+      IntVect iv = bit();
+      int indtot = D_TERM(iv[0], + iv[1], + iv[2]);
+      iv[0] += Abs((indtot + a_redBlack) % 2);
+      if (iv[0] > a_region.bigEnd(0))
+        {
+          continue;
+        }
+      int numCells = (a_region.bigEnd(0) - iv[0])/2 + 1;
+
+      Real*       phi = a_phi.dataPtr(0) + phiBox.index(iv);
+      const Real* rhs = a_rhs.dataPtr(0) + rhsBox.index(iv);
+      const float* rel = relPtr + cellBox.index(iv);
+      const float* aco = acoPtr + cellBox.index(iv);
+      const float* bco[SpaceDim];
+      for (int idir = 0; idir < SpaceDim; idir++)
+        {
+          bco[idir] = bcoPtr[idir] + m_bcoefSingle[idir][a_dit].box().index(iv);
+        }
+
+      for (int icell = 0; icell < numCells; icell++)
+        {
+          int ic = 2*icell;
+          Real phio = phi[ic];
+          Real laplphi = aco[ic]*phio;
+          for (int idir = 0; idir < SpaceDim; idir++)
+            {
+              //low face has the index of the cell, high face is one over
+              long ip = phiStride[idir];
+              long ib = bcoStride[idir];
+              laplphi += bco[idir][ic+ib]*(phi[ic+ip] - phio) - bco[idir][ic]*(phio - phi[ic-ip]);
+            }
+          phi[ic] = phio + rel[ic]*(rhs[ic] - laplphi);
+        }
+    }
 }
 //-----------------------------------------------------------------------
 void
@@ -710,6 +839,7 @@ defineStencils()
   m_ebBC->define((*m_eblg.getCFIVS()), dxScale); //has to happen AFTER coefs are set
   LayoutData<BaseIVFAB<VoFStencil> >* fluxStencil = m_ebBC->getFluxStencil(0);
 
+  m_isAllRegular.define(     m_eblg.getDBL());
   m_vofIterIrreg.define(     m_eblg.getDBL()); // vofiterator cache
   m_vofIterMulti.define(     m_eblg.getDBL()); // vofiterator cache
   m_alphaDiagWeight.define(  m_eblg.getDBL());
@@ -733,6 +863,7 @@ defineStencils()
       const Box& curBox = m_eblg.getDBL().get(dit());
       const EBISBox& ebisBox = m_eblg.getEBISL()[dit()];
       const EBGraph& ebgraph = ebisBox.getEBGraph();
+      m_isAllRegular[dit()] = ebisBox.isAllRegular();
 
       IntVectSet irregIVS = ebisBox.getIrregIVS(curBox);
       IntVectSet multiIVS = ebisBox.getMultiCells(curBox);
@@ -819,10 +950,13 @@ defineStencils()
           m_betaDiagWeight[dit()](VoF, 0)  = betaWeight;
         }
 
-      //Operator ebstencil
-      m_opEBStencil[dit()] = RefCountedPtr<EBStencil>
-        (new EBStencil(m_vofIterIrreg[dit()].getVector(), opStencil, m_eblg.getDBL().get(dit()),
-                       m_eblg.getEBISL()[dit()], m_ghostCellsPhi, m_ghostCellsRHS, 0, true));
+      //Operator ebstencil (nothing to do on all-regular boxes)
+      if (!m_isAllRegular[dit()])
+        {
+          m_opEBStencil[dit()] = RefCountedPtr<EBStencil>
+            (new EBStencil(m_vofIterIrreg[dit()].getVector(), opStencil, m_eblg.getDBL().get(dit()),
+                           m_eblg.getEBISL()[dit()], m_ghostCellsPhi, m_ghostCellsRHS, 0, true));
+        }
     }//dit
   calculateAlphaWeight();
   calculateRelaxationCoefficient();
@@ -857,6 +991,11 @@ defineColorStencils(Box a_sideBoxLo[SpaceDim],
         }
       for (DataIterator dit = m_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
         {
+          //all-regular boxes are relaxed by the regular kernel alone
+          if (m_isAllRegular[dit()])
+            {
+              continue;
+            }
 
           const EBISBox& curEBISBox = m_eblg.getEBISL()[dit()];
           const EBGraph& curEBGraph = curEBISBox.getEBGraph();
@@ -1180,6 +1319,94 @@ applyDomainFlux(Box * a_loBox,
     }
 }
 
+/***/
+void
+EBConductivityOp::
+applyOpAllRegular(BaseFab<Real>&       a_lhs,
+                  const BaseFab<Real>& a_phi,
+                  bool                 a_homogeneousPhysBC,
+                  const DataIndex&     a_dit)
+{
+  CH_TIME("EBConductivityOp::applyOpAllRegular");
+  CH_assert(m_isAllRegular[a_dit]);
+
+  Box loBox[SpaceDim],hiBox[SpaceDim];
+  int hasLo[SpaceDim],hasHi[SpaceDim];
+  Box dblBox = m_eblg.getDBL()[a_dit];
+  const BaseFab<Real>& acoFAB = (*m_acoef)[a_dit].getSingleValuedFAB();
+
+  //the kernel only covers the valid box.  the ghost cells get
+  //alpha*a*phi the way the EB path leaves them, before the domain bcs
+  //change the ghost cells of phi.  one slab per direction and side,
+  //each slab stopping at the valid range in the directions already done
+  FArrayBox& lhsFAB = (FArrayBox&) a_lhs;
+  Box slabRange = a_lhs.box();
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      for (SideIterator sit; sit.ok(); ++sit)
+        {
+          Box ghostBox = slabRange;
+          if (sit() == Side::Lo)
+            {
+              ghostBox.setBig(idir, dblBox.smallEnd(idir) - 1);
+            }
+          else
+            {
+              ghostBox.setSmall(idir, dblBox.bigEnd(idir) + 1);
+            }
+          if (ghostBox.isEmpty())
+            {
+              continue;
+            }
+          lhsFAB.setVal(0.0, ghostBox, 0, 1);
+          Box phiBox = ghostBox & a_phi.box();
+          if (!phiBox.isEmpty())
+            {
+              lhsFAB.copy(a_phi, phiBox, 0, phiBox, 0, 1);
+              lhsFAB.mult(m_alpha, phiBox, 0, 1);
+              Box acoBox = phiBox & acoFAB.box();
+              if (!acoBox.isEmpty())
+                {
+                  lhsFAB.mult((const FArrayBox&) acoFAB, acoBox, 0, 0, 1);
+                }
+            }
+        }
+      slabRange.setSmall(idir, dblBox.smallEnd(idir));
+      slabRange.setBig(  idir, dblBox.bigEnd(idir));
+    }
+
+  //domain bcs go into the ghost cells, as in incrOpRegularAllDirs
+  BaseFab<Real>& phiFAB = (BaseFab<Real>&) a_phi;
+  applyDomainFlux(loBox, hiBox, hasLo, hasHi,
+                  dblBox, 1, phiFAB,
+                  a_homogeneousPhysBC, a_dit);
+
+  //data ptr fusses if it is truly zero size
+  BaseFab<Real> dummy(Box(IntVect::Zero, IntVect::Zero), 1);
+  const BaseFab<Real>* bc[3];
+  for (int iloc = 0; iloc < 3; iloc++)
+    {
+      if (iloc >= SpaceDim)
+        {
+          bc[iloc]= &dummy;
+        }
+      else
+        {
+          bc[iloc] = &((*m_bcoef)[a_dit][iloc].getSingleValuedFAB());
+        }
+    }
+  FORT_CONDUCTIVITYAPPLYREGULAR(CHF_FRA1(a_lhs,0),
+                                CHF_CONST_FRA1(a_phi,0),
+                                CHF_CONST_FRA1(acoFAB,0),
+                                CHF_CONST_FRA1((*bc[0]),0),
+                                CHF_CONST_FRA1((*bc[1]),0),
+                                CHF_CONST_FRA1((*bc[2]),0),
+                                CHF_CONST_REAL(m_alpha),
+                                CHF_CONST_REAL(m_beta),
+                                CHF_CONST_REAL(m_dx),
+                                CHF_BOX(dblBox));
+}
+
 //-----------------------------------------------------------------------
 void
 EBConductivityOp::
@@ -1197,10 +1424,16 @@ applyOp(LevelData<EBCellFAB>&                    a_lhs,
     }
   phi.exchange(phi.interval());
 
-  EBLevelDataOps::setToZero(a_lhs);
-  incr( a_lhs, a_phi, m_alpha); //this multiplies by alpha
   for (DataIterator dit = m_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
     {
+      if (m_isAllRegular[dit()] && !s_turnOffBCs)
+        {
+          applyOpAllRegular(a_lhs[dit()].getSingleValuedFAB(), a_phi[dit()].getSingleValuedFAB(),
+                            a_homogeneousPhysBC, dit());
+          continue;
+        }
+      a_lhs[dit()].setVal(0.0);
+      a_lhs[dit()].plus(a_phi[dit()], m_alpha); //this multiplies by alpha
       a_lhs[dit()].mult((*m_acoef)[dit()], 0, 0, 1);
 
       Box loBox[SpaceDim],hiBox[SpaceDim];
@@ -1233,7 +1466,10 @@ applyOp(LevelData<EBCellFAB>&                    a_lhs,
             }
         }
 
-      applyOpIrregular(a_lhs[dit()], a_phi[dit()], a_homogeneousPhysBC, dit());
+      if (!m_isAllRegular[dit()])
+        {
+          applyOpIrregular(a_lhs[dit()], a_phi[dit()], a_homogeneousPhysBC, dit());
+        }
     }
 }
 //-----------------------------------------------------------------------
@@ -1430,6 +1666,151 @@ applyOpNoBoundary(LevelData<EBCellFAB>&        a_opPhi,
   s_turnOffBCs = false;
 }
 //-----------------------------------------------------------------------
+void
+EBConductivityOp::
+applyOpMultiComp(LevelData<EBCellFAB>&                a_lhs,
+                 const LevelData<EBCellFAB>&          a_phi,
+                 const LevelData<EBCellFAB>* const    a_phiCoar,
+                 const Vector<EBConductivityOp*>&     a_ops,
+                 RefCountedPtr<EBQuadCFInterp>&       a_quadCFI,
+                 bool                                 a_homogeneousPhysBC,
+                 bool                                 a_homogeneousCFBC)
+{
+  CH_TIME("ebco::applyOpMultiComp");
+  const int nComp = a_ops.size();
+  CH_assert(nComp > 0);
+  CH_assert(a_phi.nComp() == nComp);
+  CH_assert(a_lhs.nComp() == nComp);
+  CH_assert(!s_turnOffBCs);
+
+  //the layout and the coarse-fine structure come from the first operator
+  EBConductivityOp& op0 = *a_ops[0];
+  for (int icomp = 1; icomp < nComp; icomp++)
+    {
+      CH_assert(a_ops[icomp]->m_eblg.getDBL() == op0.m_eblg.getDBL());
+      CH_assert(a_ops[icomp]->m_hasCoar == op0.m_hasCoar);
+    }
+
+  LevelData<EBCellFAB>& phi = const_cast<LevelData<EBCellFAB>&>(a_phi);
+  if (op0.m_hasCoar)
+    {
+      if (a_homogeneousCFBC)
+        {
+          op0.applyHomogeneousCFBCs(phi);
+        }
+      else
+        {
+          if (a_phiCoar==NULL)
+            {
+              MayDay::Error("cannot enforce inhomogeneous CFBCs with NULL coar");
+            }
+          if (a_quadCFI.isNull())
+            {
+              MayDay::Error("applyOpMultiComp: inhomogeneous CFBCs need an interpolator for all the components");
+            }
+          CH_assert(a_phiCoar->nComp() == nComp);
+          a_quadCFI->interpolate(phi, *a_phiCoar, phi.interval());
+        }
+    }
+  //one message per neighbor for all the components
+  phi.exchange(phi.interval());
+
+  for (DataIterator dit = op0.m_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
+    {
+      for (int icomp = 0; icomp < nComp; icomp++)
+        {
+          a_ops[icomp]->applyOpComp(a_lhs[dit()], a_phi[dit()], icomp,
+                                    a_homogeneousPhysBC, dit());
+        }
+    }
+}
+//-----------------------------------------------------------------------
+void
+EBConductivityOp::
+applyOpComp(EBCellFAB&             a_lhs,
+            const EBCellFAB&       a_phi,
+            int                    a_comp,
+            bool                   a_homogeneousPhysBC,
+            const DataIndex&       a_datInd)
+{
+  CH_TIME("ebco::applyOpComp");
+  //the regular kernels and the domain bcs work on component zero,
+  //so hand them aliases of this component
+  FArrayBox& phiFAB = (FArrayBox&)(a_phi.getSingleValuedFAB());
+  FArrayBox& lphFAB = (FArrayBox&)(a_lhs.getSingleValuedFAB());
+  FArrayBox phiComp(Interval(a_comp, a_comp), phiFAB);
+  FArrayBox lphComp(Interval(a_comp, a_comp), lphFAB);
+  if (m_isAllRegular[a_datInd])
+    {
+      applyOpAllRegular(lphComp, phiComp, a_homogeneousPhysBC, a_datInd);
+      return;
+    }
+
+  //alpha*a*phi, as in applyOp
+  const FArrayBox& acoFAB = (const FArrayBox&)((*m_acoef)[a_datInd].getSingleValuedFAB());
+  lphComp.copy(phiComp);
+  lphComp.mult(m_alpha);
+  lphComp.mult(acoFAB, lphComp.box() & acoFAB.box(), 0, 0, 1);
+
+  Box loBox[SpaceDim],hiBox[SpaceDim];
+  int hasLo[SpaceDim],hasHi[SpaceDim];
+  Box dblBox = m_eblg.getDBL()[a_datInd];
+  Box curPhiBox = phiComp.box();
+  incrOpRegularAllDirs(loBox, hiBox, hasLo, hasHi,
+                       dblBox, curPhiBox, 1,
+                       lphComp, phiComp,
+                       a_homogeneousPhysBC, a_datInd);
+
+  //irregular cells overwrite whatever the regular kernel left there
+  RealVect vectDx = m_dx*RealVect::Unit;
+  m_opEBStencil[a_datInd]->apply(a_lhs, a_phi, m_alphaDiagWeight[a_datInd], m_alpha, m_beta, false, a_comp);
+
+  VoFIterator& vofitIrreg = m_vofIterIrreg[a_datInd];
+  vofitIrreg.reset();
+  if (!a_homogeneousPhysBC && vofitIrreg.ok())
+    {
+      //the EB bcs only write component zero (and only use phi for its geometry)
+      EBCellFAB ebFlux(a_lhs.getEBISBox(), dblBox, 1);
+      for (vofitIrreg.reset(); vofitIrreg.ok(); ++vofitIrreg)
+        {
+          ebFlux(vofitIrreg(), 0) = 0.0;
+        }
+      const Real factor = m_beta/m_dx; //beta and bcoef handled within applyEBFlux
+      m_ebBC->applyEBFlux(ebFlux, ebFlux, vofitIrreg, (*m_eblg.getCFIVS()),
+                          a_datInd, RealVect::Zero, vectDx, factor,
+                          a_homogeneousPhysBC, 0.0);
+      for (vofitIrreg.reset(); vofitIrreg.ok(); ++vofitIrreg)
+        {
+          a_lhs(vofitIrreg(), a_comp) += ebFlux(vofitIrreg(), 0);
+        }
+    }
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      VoFIterator& vofitLo = m_vofIterDomLo[idir][a_datInd];
+      for (vofitLo.reset(); vofitLo.ok(); ++vofitLo)
+        {
+          Real flux;
+          const VolIndex& vof = vofitLo();
+          m_domainBC->getFaceFlux(flux,vof,a_comp,a_phi,
+                                  RealVect::Zero,vectDx,idir,Side::Lo, a_datInd, 0.0,
+                                  a_homogeneousPhysBC);
+          //area gets multiplied in by bc operator
+          a_lhs(vof,a_comp) -= flux*m_beta/m_dx;
+        }
+      VoFIterator& vofitHi = m_vofIterDomHi[idir][a_datInd];
+      for (vofitHi.reset(); vofitHi.ok(); ++vofitHi)
+        {
+          Real flux;
+          const VolIndex& vof = vofitHi();
+          m_domainBC->getFaceFlux(flux,vof,a_comp,a_phi,
+                                  RealVect::Zero,vectDx,idir,Side::Hi,a_datInd,0.0,
+                                  a_homogeneousPhysBC);
+          //area gets multiplied in by bc operator
+          a_lhs(vof,a_comp) += flux*m_beta/m_dx;
+        }
+    }
+}
+//-----------------------------------------------------------------------
 
 //-----------------------------------------------------------------------
 void
@@ -1641,6 +2022,11 @@ relaxGSRBFast(LevelData<EBCellFAB>&       a_phi,
   CH_assert(a_phi.nComp() == 1);
   CH_assert(a_rhs.nComp() == 1);
 
+  //the flag may have been turned on after this operator was defined
+  if (s_singlePrecisionRelax && !(m_relCoefSingle.boxLayout() == m_eblg.getDBL()))
+    {
+      defineSingleCoefficients();
+    }
 
   for (int whichIter =0; whichIter < a_iterations; whichIter++)
     {
@@ -1691,7 +2077,8 @@ relaxGSRBFast(LevelData<EBCellFAB>&       a_phi,
               const EBCellFAB& rhsfab = a_rhs[dit()];
 
               //cache phi
-              for (int c = 0; c < m_colors.size()/2; ++c)
+              bool allRegular = m_isAllRegular[dit()];
+              for (int c = 0; (c < m_colors.size()/2) && !allRegular; ++c)
                 {
                   m_colorEBStencil[m_colors.size()/2*redBlack+c][dit()]->cachePhi(phifab);
                 }
@@ -1722,29 +2109,36 @@ relaxGSRBFast(LevelData<EBCellFAB>&       a_phi,
                 }
 
 
-              for (int comp = 0; comp < a_phi.nComp(); comp++)
+              if (s_singlePrecisionRelax)
                 {
-                  FORT_CONDUCTIVITYGSRB(CHF_FRA1(        reguPhi,    comp),
-                                        CHF_CONST_FRA1(  reguRHS,    comp),
-                                        CHF_CONST_FRA1(  relCoef,    comp),
-                                        CHF_CONST_FRA1(  regACoe,    comp),
-                                        CHF_CONST_FRA1((*regBCoe[0]),comp),
-                                        CHF_CONST_FRA1((*regBCoe[1]),comp),
-                                        CHF_CONST_FRA1((*regBCoe[2]),comp),
-                                        CHF_CONST_REAL(m_alpha),
-                                        CHF_CONST_REAL(m_beta),
-                                        CHF_CONST_REAL(m_dx),
-                                        CHF_BOX(region),
-                                        CHF_CONST_INT(redBlack));
+                  gsrbRegularSingle(reguPhi, reguRHS, region, dit(), redBlack);
+                }
+              else
+                {
+                  for (int comp = 0; comp < a_phi.nComp(); comp++)
+                    {
+                      FORT_CONDUCTIVITYGSRB(CHF_FRA1(        reguPhi,    comp),
+                                            CHF_CONST_FRA1(  reguRHS,    comp),
+                                            CHF_CONST_FRA1(  relCoef,    comp),
+                                            CHF_CONST_FRA1(  regACoe,    comp),
+                                            CHF_CONST_FRA1((*regBCoe[0]),comp),
+                                            CHF_CONST_FRA1((*regBCoe[1]),comp),
+                                            CHF_CONST_FRA1((*regBCoe[2]),comp),
+                                            CHF_CONST_REAL(m_alpha),
+                                            CHF_CONST_REAL(m_beta),
+                                            CHF_CONST_REAL(m_dx),
+                                            CHF_BOX(region),
+                                            CHF_CONST_INT(redBlack));
+                    }
                 }
 
               //uncache phi
-              for (int c = 0; c < m_colors.size()/2; ++c)
+              for (int c = 0; (c < m_colors.size()/2) && !allRegular; ++c)
                 {
                   m_colorEBStencil[m_colors.size()/2*redBlack+c][dit()]->uncachePhi(phifab);
                 }
 
-              for (int c = 0; c < m_colors.size()/2; ++c)
+              for (int c = 0; (c < m_colors.size()/2) && !allRegular; ++c)
                 {
                   GSColorAllIrregular(phifab, rhsfab, m_colors.size()/2*redBlack+c, dit());
                 }
@@ -2058,7 +2452,6 @@ EBConductivityOp::
 applyHomogeneousCFBCs(LevelData<EBCellFAB>&   a_phi)
 {
   CH_TIME("EBConductivityOp::applyHomogeneousCFBCs");
-  CH_assert(a_phi.nComp() == 1);
   CH_assert( a_phi.ghostVect() >= IntVect::Unit);
   for (DataIterator dit = m_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
     {
@@ -2086,8 +2479,9 @@ applyHomogeneousCFBCs(EBCellFAB&            a_phi,
       CH_TIMER("unpacked_applyHomogeneousCFBCs",t2);
       CH_assert((a_idir >= 0) && (a_idir  < SpaceDim));
       CH_assert((a_hiorlo == Side::Lo )||(a_hiorlo == Side::Hi ));
-      CH_assert(a_phi.nComp() == 1);
-      int ivar = 0;
+      //the interpolation has no coefficients so every component
+      //gets the same treatment
+      const int nComp = a_phi.nComp();
 
       const CFIVS* cfivsPtr = NULL;
 
@@ -2144,55 +2538,60 @@ applyHomogeneousCFBCs(EBCellFAB&            a_phi,
                                                                1);
                   bool hasClose = (closeVoFs.size() > 0);
                   bool hasFar = false;
-                  Real phic = 0.0;
-                  Real phif = 0.0;
                   if (hasClose)
                     {
-                      const int& numClose = closeVoFs.size();
-                      for (int iVof=0;iVof<numClose;iVof++)
-                        {
-                          const VolIndex& vofClose = closeVoFs[iVof];
-                          phic += a_phi(vofClose,0);
-                        }
-                      phic /= Real(numClose);
-
                       farVoFs = ebisBox.getVoFs(VoFGhost,
                                                 a_idir,
                                                 flip(a_hiorlo),
                                                 2);
                       hasFar   = (farVoFs.size()   > 0);
-                      if (hasFar)
+                    }
+                  const int& numClose = closeVoFs.size();
+                  const int& numFar   = farVoFs.size();
+                  for (int ivar = 0; ivar < nComp; ivar++)
+                    {
+                      Real phic = 0.0;
+                      Real phif = 0.0;
+                      if (hasClose)
                         {
-                          const int& numFar = farVoFs.size();
-                          for (int iVof=0;iVof<numFar;iVof++)
+                          for (int iVof=0;iVof<numClose;iVof++)
+                            {
+                              const VolIndex& vofClose = closeVoFs[iVof];
+                              phic += a_phi(vofClose,ivar);
+                            }
+                          phic /= Real(numClose);
+                          if (hasFar)
                             {
-                              const VolIndex& vofFar = farVoFs[iVof];
-                              phif += a_phi(vofFar,0);
+                              for (int iVof=0;iVof<numFar;iVof++)
+                                {
+                                  const VolIndex& vofFar = farVoFs[iVof];
+                                  phif += a_phi(vofFar,ivar);
+                                }
+                              phif /= Real(numFar);
                             }
-                          phif /= Real(numFar);
                         }
-                    }
 
-                  Real phiGhost;
-                  if (hasClose && hasFar)
-                    {
-                      // quadratic interpolation  phi = ax^2 + bx + c
-                      Real A = (phif*xc - phic*xf)/denom;
-                      Real B = (phic*hf*xf - phif*xc*xc + phic*xf*xc)/denom;
+                      Real phiGhost;
+                      if (hasClose && hasFar)
+                        {
+                          // quadratic interpolation  phi = ax^2 + bx + c
+                          Real A = (phif*xc - phic*xf)/denom;
+                          Real B = (phic*hf*xf - phif*xc*xc + phic*xf*xc)/denom;
 
-                      phiGhost = A*xg*xg + B*xg;
-                    }
-                  else if (hasClose)
-                    {
-                      //linear interpolation
-                      Real slope =  phic/xc;
-                      phiGhost   =  slope*xg;
-                    }
-                  else
-                    {
-                      phiGhost = 0.0; //nothing to interpolate from
+                          phiGhost = A*xg*xg + B*xg;
+                        }
+                      else if (hasClose)
+                        {
+                          //linear interpolation
+                          Real slope =  phic/xc;
+                          phiGhost   =  slope*xg;
+                        }
+                      else
+                        {
+                          phiGhost = 0.0; //nothing to interpolate from
+                        }
+                      a_phi(VoFGhost, ivar) = phiGhost;
                     }
-                  a_phi(VoFGhost, ivar) = phiGhost;
                 }
               CH_STOP(t2);
             }
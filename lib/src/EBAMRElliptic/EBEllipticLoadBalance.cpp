@@ -148,4 +148,22 @@ EBEllipticLoadBalance(Vector<int>&         a_procs,
 
   return retval;
 }
+///////////////
+int getAgglomerationRank(const DisjointBoxLayout& a_grids)
+{
+  Vector<long long> points(numProc(), 0);
+  for (LayoutIterator lit = a_grids.layoutIterator(); lit.ok(); ++lit)
+    {
+      points[a_grids.procID(lit())] += a_grids[lit()].numPts();
+    }
+  int retval = 0;
+  for (int iproc = 1; iproc < points.size(); iproc++)
+    {
+      if (points[iproc] > points[retval])
+        {
+          retval = iproc;
+        }
+    }
+  return retval;
+}
 #include "NamespaceFooter.H"
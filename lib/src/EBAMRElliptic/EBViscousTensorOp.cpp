@@ -22,6 +22,7 @@
 #include "ParmParse.H"
 #include "NamespaceHeader.H"
 bool EBViscousTensorOp::s_doLazyRelax = false;
+bool EBViscousTensorOp::s_singlePrecisionRelax = false;
 bool EBViscousTensorOp::s_turnOffBCs = false; //needs to default to
                                               //false
 int EBViscousTensorOp::s_whichLev = -1;
@@ -85,7 +86,9 @@ EBViscousTensorOp(const EBLevelGrid &                                a_eblgFine,
   m_ghostCellsRHS(a_ghostCellsRHS),
   m_opEBStencil(),
   m_relCoef(),
+  m_relCoefSingle(),
   m_grad(),
+  m_isAllRegular(),
   m_vofIterIrreg(),
   m_vofIterMulti(),
   m_vofIterDomLo(),
@@ -193,6 +196,7 @@ defineStencils()
       m_divergenceStencil[dit()] = RefCountedPtr<DivergenceStencil>( new DivergenceStencil(dumEBCF, dumEBFF, dumbiv, smallBox, ebisBox, m_dx*RealVect::Unit, false));
     }
 
+  m_isAllRegular.define(m_eblg.getDBL());
   m_vofIterIrreg.define(m_eblg.getDBL());
   m_vofIterMulti.define(m_eblg.getDBL());
   m_alphaDiagWeight.define(  m_eblg.getDBL());
@@ -223,6 +227,7 @@ defineStencils()
     {
       const EBISBox& ebisBox = m_eblg.getEBISL()[dit()];
       const Box&     grid = m_eblg.getDBL().get(dit());
+      m_isAllRegular[dit()] = ebisBox.isAllRegular();
       //need to grow the irregular set by one near multivalued cells
       IntVectSet ivsIrreg = ebisBox.getIrregIVS(grid);
       IntVectSet ivsMulti = ebisBox.getMultiCells(grid);
@@ -293,10 +298,13 @@ defineStencils()
               m_betaDiagWeight[dit()](vof, ivar) = diagWeight;
             }
 
-          m_opEBStencil[ivar][dit()] = RefCountedPtr<EBStencil>
-            (new EBStencil(m_vofIterIrreg[dit()].getVector(),  slowStencil[dit()],
-                           m_eblg.getDBL().get(dit()), m_eblg.getEBISL()[dit()],
-                           m_ghostCellsPhi, m_ghostCellsRHS, ivar, true));
+          if (!m_isAllRegular[dit()])
+            {
+              m_opEBStencil[ivar][dit()] = RefCountedPtr<EBStencil>
+                (new EBStencil(m_vofIterIrreg[dit()].getVector(),  slowStencil[dit()],
+                               m_eblg.getDBL().get(dit()), m_eblg.getEBISL()[dit()],
+                               m_ghostCellsPhi, m_ghostCellsRHS, ivar, true));
+            }
 
         }
     }
@@ -385,7 +393,9 @@ EBViscousTensorOp(const EBLevelGrid &                                a_eblgFine,
   m_ghostCellsRHS(a_ghostCellsRHS),
   m_opEBStencil(),
   m_relCoef(),
+  m_relCoefSingle(),
   m_grad(),
+  m_isAllRegular(),
   m_vofIterIrreg(),
   m_vofIterMulti(),
   m_vofIterDomLo(),
@@ -1067,6 +1077,72 @@ calculateRelaxationCoefficient()
             }
         }
     }
+
+  if (s_singlePrecisionRelax)
+    {
+      defineSingleCoefficients();
+    }
+}
+//-----------------------------------------------------------------------
+void
+EBViscousTensorOp::
+defineSingleCoefficients()
+{
+  CH_TIME("ebvto::defineSingleCoefficients");
+  const DisjointBoxLayout& dbl = m_eblg.getDBL();
+  m_relCoefSingle.define(dbl);
+  for (DataIterator dit = dbl.dataIterator(); dit.ok(); ++dit)
+    {
+      const Box& grid = dbl.get(dit());
+      const BaseFab<Real>& regRel = m_relCoef[dit()].getSingleValuedFAB();
+      BaseFab<float>& relSingle = m_relCoefSingle[dit()];
+      relSingle.resize(grid, SpaceDim);
+      for (int ivar = 0; ivar < SpaceDim; ivar++)
+        {
+          for (BoxIterator bit(grid); bit.ok(); ++bit)
+            {
+              relSingle(bit(), ivar) = regRel(bit(), ivar);
+            }
+        }
+    }
+}
+//-----------------------------------------------------------------------
+//same update as FORT_GSRBVTOP, reading the single precision coefficient
+void
+EBViscousTensorOp::
+gsrbColorSingle(BaseFab<Real>&       a_phi,
+                const BaseFab<Real>& a_lph,
+                const BaseFab<Real>& a_rhs,
+                const Box&           a_coloredBox,
+                const DataIndex&     a_dit)
+{
+  const BaseFab<float>& relSingle = m_relCoefSingle[a_dit];
+  const Box& phiBox = a_phi.box();
+  const Box& lphBox = a_lph.box();
+  const Box& rhsBox = a_rhs.box();
+  const Box& relBox = relSingle.box();
+
+  //the colored cells are every other cell in each direction, one pass per row
+  const IntVect& loIV = a_coloredBox.smallEnd();
+  Box rows(IntVect::Zero, (a_coloredBox.bigEnd() - loIV)/2);
+  int numCells = rows.bigEnd(0) + 1;
+  rows.setBig(0, 0);
+  for (int ivar = 0; ivar < SpaceDim; ivar++)
+    {
+      for (BoxIterator bit(rows); bit.ok(); ++bit)
+        {
+          IntVect iv = loIV + 2*bit();
+          Real*        phi = a_phi.dataPtr(ivar)     + phiBox.index(iv);
+          const Real*  lph = a_lph.dataPtr(ivar)     + lphBox.index(iv);
+          const Real*  rhs = a_rhs.dataPtr(ivar)     + rhsBox.index(iv);
+          const float* rel = relSingle.dataPtr(ivar) + relBox.index(iv);
+          for (int icell = 0; icell < numCells; icell++)
+            {
+              int ic = 2*icell;
+              phi[ic] += rel[ic]*(rhs[ic] - lph[ic]);
+            }
+        }
+    }
 }
 //-----------------------------------------------------------------------
 
@@ -1502,6 +1578,11 @@ relax(LevelData<EBCellFAB>&       a_phi,
   CH_assert(a_rhs.isDefined());
   CH_assert(a_phi.ghostVect() >= IntVect::Unit);
   CH_assert(a_phi.nComp() == a_rhs.nComp());
+  //the flag may have been turned on after this operator was defined
+  if (s_singlePrecisionRelax && !(m_relCoefSingle.boxLayout() == m_eblg.getDBL()))
+    {
+      defineSingleCoefficients();
+    }
   LevelData<EBCellFAB> lphi;
   create(lphi, a_rhs);
   // do first red, then black passes
@@ -1528,10 +1609,9 @@ homogeneousCFInterp(LevelData<EBCellFAB>&   a_phi)
   CH_TIME("ebvto::homogCFI.1");
   if (m_hasCoar)
     {
-      EBCellFactory factCoarse(m_eblgCoar.getEBISL());
-      LevelData<EBCellFAB> phiCoarse(m_eblgCoar.getDBL(), a_phi.nComp(), a_phi.ghostVect(), factCoarse);
-      EBLevelDataOps::setToZero(phiCoarse);
-      cfinterp(a_phi, phiCoarse);
+      //same as cfinterp with zero coarse data, without building any
+      EBLevelDataOps::setToZero(m_grad);
+      m_interpWithCoarser->coarseFineInterpH(a_phi, m_grad);
     }
 }
 /*****/
@@ -1566,12 +1646,19 @@ gsrbColor(LevelData<EBCellFAB>&       a_phi,
         {
           int ncomp = SpaceDim;
           Box coloredBox(loIV, hiIV);
-          FORT_GSRBVTOP(CHF_FRA(regPhi),
-                        CHF_CONST_FRA(regLph),
-                        CHF_CONST_FRA(regRhs),
-                        CHF_CONST_FRA(regRel),
-                        CHF_BOX(coloredBox),
-                        CHF_CONST_INT(ncomp));
+          if (s_singlePrecisionRelax)
+            {
+              gsrbColorSingle(regPhi, regLph, regRhs, coloredBox, dit());
+            }
+          else
+            {
+              FORT_GSRBVTOP(CHF_FRA(regPhi),
+                            CHF_CONST_FRA(regLph),
+                            CHF_CONST_FRA(regRhs),
+                            CHF_CONST_FRA(regRel),
+                            CHF_BOX(coloredBox),
+                            CHF_CONST_INT(ncomp));
+            }
         }
 
       for (m_vofIterMulti[dit()].reset(); m_vofIterMulti[dit()].ok(); ++m_vofIterMulti[dit()])
@@ -2050,7 +2137,11 @@ applyOp(LevelData<EBCellFAB>&             a_lhs,
         {
           incrOpRegularDir(a_lhs[dit()], a_phi[dit()], a_homogeneous, idir, dit());
         }
-      applyOpIrregular(a_lhs[dit()], a_phi[dit()], a_homogeneous, dit());
+      //no irregular cells, no stencils, no EB or domain fluxes at them
+      if (!m_isAllRegular[dit()])
+        {
+          applyOpIrregular(a_lhs[dit()], a_phi[dit()], a_homogeneous, dit());
+        }
     }
 }
 
@@ -2315,6 +2406,7 @@ cellGrad(EBCellFAB&             a_gradPhi,
                               CHF_CONST_INT(hasLo),
                               CHF_CONST_INT(hasHi),
                               CHF_CONST_INT(derivDir));
+          if (!m_isAllRegular[a_datInd])
           {
             CH_TIME("ebvto::fillgrad::irreg");
             for (m_vofIterIrreg[a_datInd].reset(); m_vofIterIrreg[a_datInd].ok(); ++m_vofIterIrreg[a_datInd])
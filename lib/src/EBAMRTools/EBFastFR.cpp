@@ -877,6 +877,133 @@ incrementFineSparse(const EBFaceFAB&      a_fineFlux,
 /*******************/
 void
 EBFastFR::
+incrementCoarseAll(const EBFluxFAB&       a_coarFlux,
+                   const BaseIFFAB<Real>  a_centroidFlux[SpaceDim],
+                   const Real&            a_scale,
+                   const DataIndex&       a_coarDatInd,
+                   const Interval&        a_variables)
+{
+  CH_TIME("EBFastFR::incrementCoarseAll");
+  CH_assert(m_isDefined);
+  const EBISBox& ebisBox = m_eblgCoar.getEBISL()[a_coarDatInd];
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      FArrayBox& coarFluxFAB = (FArrayBox&)(a_coarFlux[idir].getFArrayBox());
+      const BaseIFFAB<Real>& centFlux = a_centroidFlux[idir];
+      for (SideIterator sit; sit.ok(); ++sit)
+        {
+          //increment  as if there were no EB
+          m_levelFluxReg->incrementCoarse(coarFluxFAB, a_scale, a_coarDatInd,
+                                          a_variables, a_variables, idir, sit());
+          if (m_hasEBCF && centFlux.isDefined())
+            {
+              const IntVectSet& centIVS = centFlux.getIVS();
+              int iindex = index(idir, sit());
+              EBCellFAB& delUCoar = m_delUCoar[a_coarDatInd];
+              Vector<VoFIterator>& vofits = (m_vofiCoar[iindex])[a_coarDatInd];
+              for (int ivofits = 0; ivofits < vofits.size(); ivofits++)
+                {
+                  VoFIterator& vofit = vofits[ivofits];
+                  for (vofit.reset(); vofit.ok(); ++vofit)
+                    {
+                      const VolIndex& vof = vofit();
+                      //only faces of irregular cells carry centroid fluxes
+                      if (!centIVS.contains(vof.gridIndex())) continue;
+
+                      //coarse side of the face so look back at it---ergo flip
+                      Vector<FaceIndex> faces = ebisBox.getFaces(vof, idir, flip(sit()));
+                      for (int iface = 0; iface < faces.size(); iface++)
+                        {
+                          const FaceIndex& face = faces[iface];
+                          Real area = ebisBox.areaFrac(face);
+                          for (int ivar = a_variables.begin(); ivar <= a_variables.end(); ivar++)
+                            {
+                              delUCoar(vof, ivar) -= a_scale*area*centFlux(face, ivar);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+/*******************/
+void
+EBFastFR::
+incrementFineAll(const EBFluxFAB&       a_fineFlux,
+                 const BaseIFFAB<Real>  a_centroidFlux[SpaceDim],
+                 const Real&            a_scale,
+                 const DataIndex&       a_fineDatInd,
+                 const Interval&        a_variables)
+{
+  CH_TIME("EBFastFR::incrementFineAll");
+  CH_assert(m_isDefined);
+  const EBISBox& ebisBoxFine = m_eblgFine.getEBISL()[a_fineDatInd];
+  const EBISBox& ebisBoxCoFi = m_eblgCoFi.getEBISL()[a_fineDatInd];
+  Real newScale = a_scale/m_nrefdmo;
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      const EBFaceFAB& fineFluxDir = a_fineFlux[idir];
+      FArrayBox& fineFluxFAB = (FArrayBox&)(fineFluxDir.getFArrayBox());
+      const BaseIFFAB<Real>& centFlux = a_centroidFlux[idir];
+      for (SideIterator sit; sit.ok(); ++sit)
+        {
+          //increment  as if there were no EB
+          m_levelFluxReg->incrementFine(fineFluxFAB, a_scale, a_fineDatInd,
+                                        a_variables, a_variables, idir, sit());
+          if (m_hasEBCF)
+            {
+              int iindex = index(idir, sit());
+              EBCellFAB& delUCoFi = m_delUCoFi[a_fineDatInd];
+              VoFIterator& vofit  = (m_vofiCoFi[iindex])[a_fineDatInd];
+              for (vofit.reset(); vofit.ok(); ++vofit)
+                {
+                  //remember the registers live at the coar level
+                  const VolIndex& coarVoF = vofit();
+                  Vector<FaceIndex> facesCoar = ebisBoxCoFi.getFaces(coarVoF, idir, flip(sit()));
+                  for (int ifacec = 0; ifacec < facesCoar.size(); ifacec++)
+                    {
+                      Vector<FaceIndex> facesFine =
+                        m_eblgCoFi.getEBISL().refine(facesCoar[ifacec], m_refRat, a_fineDatInd);
+                      for (int ifacef = 0; ifacef < facesFine.size(); ifacef++)
+                        {
+                          const FaceIndex& faceFine = facesFine[ifacef];
+                          VolIndex vofFine = faceFine.getVoF(flip(sit()));
+                          //regular and irregular fine vofs in the same pass
+                          const BaseIFFAB<Real>* irregFlux = NULL;
+                          if (!ebisBoxFine.isRegular(vofFine.gridIndex()))
+                            {
+                              if (!centFlux.isDefined() ||
+                                  !centFlux.getIVS().contains(vofFine.gridIndex()))
+                                {
+                                  continue;
+                                }
+                              irregFlux = &centFlux;
+                            }
+                          Real areaScale = newScale*ebisBoxFine.areaFrac(faceFine);
+                          for (int ivar = a_variables.begin(); ivar <= a_variables.end(); ivar++)
+                            {
+                              Real flux;
+                              if (irregFlux == NULL)
+                                {
+                                  flux = fineFluxDir(faceFine, ivar);
+                                }
+                              else
+                                {
+                                  flux = (*irregFlux)(faceFine, ivar);
+                                }
+                              delUCoFi(coarVoF, ivar) += areaScale*flux;
+                            }
+                        } //end loop over fine faces
+                    }// end loop over coarse faces
+                }//end loop over EBCF vofs
+            }
+        }
+    }
+}
+/*******************/
+void
+EBFastFR::
 reflux(LevelData<EBCellFAB>& a_uCoar,
        const Interval&       a_variables,
        const Real&           a_scale,
@@ -23,6 +23,20 @@
 IntVect EBQuadCFInterp::s_ivDebFine= IntVect(D_DECL(963,736,0));
 IntVect EBQuadCFInterp::s_ivDebCoar= IntVect(D_DECL(481,368,0));
 
+/***********************/
+//the stencils are built for variable zero.  applyVoFStencil uses the
+//variables stored in the stencil, so it cannot be used for the other components.
+static Real
+applyStencilToComp(const VoFStencil& a_sten, const EBCellFAB& a_fab, int a_comp)
+{
+  Real retval = 0.;
+  for (int isten = 0; isten < a_sten.size(); isten++)
+    {
+      retval += (a_sten.weight(isten))*(a_fab((a_sten.vof(isten)), a_comp));
+    }
+  return retval;
+}
+
 /***********************/
 bool
 EBQuadCFInterp::isDefined() const
@@ -440,8 +454,8 @@ interpEBCFCrossing(LevelData<EBCellFAB>&       a_fineData,
               const VoFStencil& coarSten = m_coarStencilLo[idir][dit()](vofGhost, 0);
               for (int icomp = a_variables.begin(); icomp <= a_variables.end(); icomp++)
                 {
-                  Real fineContrib = applyVoFStencil(fineSten,              a_fineData[dit()], icomp);
-                  Real coarContrib = applyVoFStencil(coarSten, m_ebBufferCoarsenedFine[dit()], icomp);
+                  Real fineContrib = applyStencilToComp(fineSten,              a_fineData[dit()], icomp);
+                  Real coarContrib = applyStencilToComp(coarSten, m_ebBufferCoarsenedFine[dit()], icomp);
                   a_fineData[dit()](vofGhost, icomp) = fineContrib + coarContrib;
                 }
             }
@@ -452,8 +466,8 @@ interpEBCFCrossing(LevelData<EBCellFAB>&       a_fineData,
               const VoFStencil& coarSten = m_coarStencilHi[idir][dit()](vofGhost, 0);
               for (int icomp = a_variables.begin(); icomp <= a_variables.end(); icomp++)
                 {
-                  Real fineContrib = applyVoFStencil(fineSten,              a_fineData[dit()], icomp);
-                  Real coarContrib = applyVoFStencil(coarSten, m_ebBufferCoarsenedFine[dit()], icomp);
+                  Real fineContrib = applyStencilToComp(fineSten,              a_fineData[dit()], icomp);
+                  Real coarContrib = applyStencilToComp(coarSten, m_ebBufferCoarsenedFine[dit()], icomp);
                   a_fineData[dit()](vofGhost, icomp) = fineContrib + coarContrib;
                 }
             }
@@ -463,10 +477,49 @@ interpEBCFCrossing(LevelData<EBCellFAB>&       a_fineData,
 /***********************/
 void
 EBQuadCFInterp::
+interpEBCFCrossingH(LevelData<EBCellFAB>&       a_fineData,
+                    const Interval&             a_variables)
+{
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      for (DataIterator dit = m_ebcfdata->m_gridsFine.dataIterator(); dit.ok(); ++dit)
+        {
+          for (m_ebcfdata->m_vofItEBCFLo[idir][dit()].reset(); m_ebcfdata->m_vofItEBCFLo[idir][dit()].ok(); ++m_ebcfdata->m_vofItEBCFLo[idir][dit()])
+            {
+              const   VolIndex& vofGhost =  (m_ebcfdata->m_vofItEBCFLo[idir][dit()])();
+              const VoFStencil& fineSten = m_fineStencilLo[idir][dit()](vofGhost, 0);
+              for (int icomp = a_variables.begin(); icomp <= a_variables.end(); icomp++)
+                {
+                  a_fineData[dit()](vofGhost, icomp) = applyStencilToComp(fineSten, a_fineData[dit()], icomp);
+                }
+            }
+          for (m_ebcfdata->m_vofItEBCFHi[idir][dit()].reset(); m_ebcfdata->m_vofItEBCFHi[idir][dit()].ok(); ++m_ebcfdata->m_vofItEBCFHi[idir][dit()])
+            {
+              const   VolIndex& vofGhost =  (m_ebcfdata->m_vofItEBCFHi[idir][dit()])();
+              const VoFStencil& fineSten = m_fineStencilHi[idir][dit()](vofGhost, 0);
+              for (int icomp = a_variables.begin(); icomp <= a_variables.end(); icomp++)
+                {
+                  a_fineData[dit()](vofGhost, icomp) = applyStencilToComp(fineSten, a_fineData[dit()], icomp);
+                }
+            }
+        }
+    }
+}
+/***********************/
+void
+EBQuadCFInterp::
 interpEBCFCorners(LevelData<EBCellFAB>&       a_fineData,
                   const LevelData<EBCellFAB>& a_coarData,
                   const Interval&             a_variables)
 {
+  interpEBCFCorners(a_fineData, a_variables);
+}
+/***********************/
+void
+EBQuadCFInterp::
+interpEBCFCorners(LevelData<EBCellFAB>&       a_fineData,
+                  const Interval&             a_variables)
+{
 
   a_fineData.exchange(a_variables);
 
@@ -480,7 +533,7 @@ interpEBCFCorners(LevelData<EBCellFAB>&       a_fineData,
           const VoFStencil& stencil = m_stencilEdges[dit()](vofEdge, 0);
           for (int icomp = a_variables.begin(); icomp <= a_variables.end(); icomp++)
             {
-              Real edgeVal = applyVoFStencil(stencil, a_fineData[dit()], icomp);
+              Real edgeVal = applyStencilToComp(stencil, a_fineData[dit()], icomp);
               //if the stencil is empty, I cannot see how the value in
               //the ghost cell matters
               a_fineData[dit()](vofEdge, icomp) = edgeVal;
@@ -493,7 +546,7 @@ interpEBCFCorners(LevelData<EBCellFAB>&       a_fineData,
           const VoFStencil& stencil = m_stencilCorners[dit()](vofCorn, 0);
           for (int icomp = a_variables.begin(); icomp <= a_variables.end(); icomp++)
             {
-              Real cornerVal = applyVoFStencil(stencil, a_fineData[dit()], icomp);
+              Real cornerVal = applyStencilToComp(stencil, a_fineData[dit()], icomp);
               a_fineData[dit()](vofCorn, icomp) = cornerVal;
             }
         }
@@ -185,10 +185,53 @@ EBTensorCFInterp::
 coarseFineInterpH(LevelData<EBCellFAB>& a_fineData,
                   LevelData<EBCellFAB>& a_tanGradF)
 {
-  EBCellFactory        fact(m_ebcfdata->m_ebislCoar);
-  LevelData<EBCellFAB> zero(m_ebcfdata->m_gridsCoar, a_fineData.nComp(), a_fineData.ghostVect(), fact);
-  EBLevelDataOps::setVal(zero, 0.0);
-  coarseFineInterp(a_fineData, a_tanGradF, zero);
+  CH_TIME("EBTensorCFInterp::coarseFineInterpH");
+  CH_assert(a_fineData.nComp() == m_nComp);
+  CH_assert(a_tanGradF.nComp() == SpaceDim*m_nComp);
+  //the coarse data are zero, so nothing coarse is allocated, copied or read
+  LevelData<FArrayBox> fineDataLDFAB, tanGradFLDFAB;
+
+  aliasEB(fineDataLDFAB, a_fineData);
+  aliasEB(tanGradFLDFAB, a_tanGradF);
+  //coarseFineInterp exchanges the fine data before it interpolates
+  fineDataLDFAB.exchange();
+  TensorCFInterp::coarseFineInterpH(fineDataLDFAB, tanGradFLDFAB);
+
+  //the EB corrections of the gradients only use coarse data, so they vanish
+  Interval interv(0, m_nComp-1);
+  if (m_doEBCFCrossing)
+    {
+      m_ebquadcfi->interpEBCFCrossingH(a_fineData, interv);
+      for (int facedir = 0; facedir < SpaceDim; facedir++)
+        {
+          for (DataIterator dit = m_ebcfdata->m_gridsFine.dataIterator(); dit.ok(); ++dit)
+            {
+              setGradToZero(a_tanGradF[dit()], m_ebcfdata->m_vofItEBCFLo[facedir][dit()]);
+              setGradToZero(a_tanGradF[dit()], m_ebcfdata->m_vofItEBCFHi[facedir][dit()]);
+            }
+        }
+    }
+
+  m_ebquadcfi->interpEBCFCorners(a_fineData, interv);
+  for (DataIterator dit = m_ebcfdata->m_gridsFine.dataIterator(); dit.ok(); ++dit)
+    {
+      setGradToZero(a_tanGradF[dit()], m_ebcfdata->m_vofItCorners[dit()]);
+      setGradToZero(a_tanGradF[dit()], m_ebcfdata->m_vofItEdges[dit()]);
+    }
+}
+/***********************/
+void
+EBTensorCFInterp::
+setGradToZero(EBCellFAB&   a_tanGradF,
+              VoFIterator& a_vofit)
+{
+  for (a_vofit.reset(); a_vofit.ok(); ++a_vofit)
+    {
+      for (int icomp = 0; icomp < SpaceDim*m_nComp; icomp++)
+        {
+          a_tanGradF(a_vofit(), icomp) = 0.;
+        }
+    }
 }
 /***********************/
 EBTensorCFInterp::~EBTensorCFInterp()
@@ -217,7 +217,8 @@ void EBStencil::apply(EBCellFAB&             a_lofphi,
                       const BaseIVFAB<Real>& a_alphaWeight,
                       Real                   a_alpha,
                       Real                   a_beta,
-                      bool                   a_incrementOnly) const
+                      bool                   a_incrementOnly,
+                      int                    a_ivar) const
 
 {
   if (!m_doRelaxOpt)
@@ -232,11 +233,11 @@ void EBStencil::apply(EBCellFAB&             a_lofphi,
   CH_assert(a_lofphi.getSingleValuedFAB().box() == m_lphBox);
   CH_assert(a_phi.getSingleValuedFAB().box()    == m_phiBox);
 
-  const Real* singleValuedPtrPhi =    a_phi.getSingleValuedFAB().dataPtr(0);
-  Real*       singleValuedPtrLph = a_lofphi.getSingleValuedFAB().dataPtr(0);
+  const Real* singleValuedPtrPhi =    a_phi.getSingleValuedFAB().dataPtr(a_ivar);
+  Real*       singleValuedPtrLph = a_lofphi.getSingleValuedFAB().dataPtr(a_ivar);
 
-  const Real* multiValuedPtrPhi =    a_phi.getMultiValuedFAB().dataPtr(0);
-  Real*       multiValuedPtrLph = a_lofphi.getMultiValuedFAB().dataPtr(0);
+  const Real* multiValuedPtrPhi =    a_phi.getMultiValuedFAB().dataPtr(a_ivar);
+  Real*       multiValuedPtrLph = a_lofphi.getMultiValuedFAB().dataPtr(a_ivar);
 
   const Real* alphaWeightPtr = a_alphaWeight.dataPtr(0);
 
@@ -0,0 +1,268 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <iostream>
+#include <cstring>
+using std::endl;
+
+#include "LoadBalance.H"
+#include "BRMeshRefine.H"
+#include "parstream.H"
+#include "BoxIterator.H"
+#include "AMRPoissonOp.H"
+#include "AMRMultiGrid.H"
+#include "BCFunc.H"
+#include "BiCGStabSolver.H"
+
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testKrylovAMRMultiGrid" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = false ;
+
+static int  nCells = 32;
+static Real dx = 1.0/nCells;
+
+///
+// Parse the standard test options (-v -q) out of the command line.
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+    {
+      if ( argv[i][0] == '-' ) //if it is an option
+        {
+          // compare 3 chars to differentiate -x from -xx
+          if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+            {
+              verbose = true ;
+            }
+          else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+            {
+              verbose = false ;
+            }
+        }
+    }
+  return ;
+}
+
+extern "C"
+{
+  void Parabola_diri(Real* pos,
+                     int* dir,
+                     Side::LoHiSide* side,
+                     Real* a_values)
+  {
+    a_values[0] = D_TERM(pos[0]*pos[0], +pos[1]*pos[1], +pos[2]*pos[2]);
+  }
+
+  void DirParabolaBC(FArrayBox& a_state,
+                     const Box& valid,
+                     const ProblemDomain& a_domain,
+                     Real a_dx,
+                     bool a_homogeneous)
+  {
+    //only on the faces of the domain
+    for (int i=0; i<CH_SPACEDIM; ++i)
+      {
+        if (!a_domain.domainBox().contains(adjCellLo(valid, i, 1)))
+          {
+            DiriBC(a_state, valid, a_dx, a_homogeneous, Parabola_diri, i, Side::Lo);
+          }
+        if (!a_domain.domainBox().contains(adjCellHi(valid, i, 1)))
+          {
+            DiriBC(a_state, valid, a_dx, a_homogeneous, Parabola_diri, i, Side::Hi);
+          }
+      }
+  }
+}
+
+//two levels, the finer one covering the middle of the domain
+void makeHierarchy(Vector<DisjointBoxLayout>& a_grids,
+                   Vector<int>&               a_refRatios,
+                   const ProblemDomain&       a_domain)
+{
+  a_grids.resize(2);
+  a_refRatios.resize(2, 2);
+
+  Vector<Box> boxes;
+  Vector<int> procs;
+  domainSplit(a_domain, boxes, 16, 8);
+  LoadBalance(procs, boxes);
+  a_grids[0].define(boxes, procs, a_domain);
+
+  Box fineBox(nCells/4*IntVect::Unit, (3*nCells/4 - 1)*IntVect::Unit);
+  fineBox.refine(a_refRatios[0]);
+  ProblemDomain fineDomain = refine(a_domain, a_refRatios[0]);
+  boxes.resize(0);
+  domainSplit(fineBox, boxes, 16, 8);
+  LoadBalance(procs, boxes);
+  a_grids[1].define(boxes, procs, fineDomain);
+}
+
+//returns the exit status of the solve and the number of V-cycles it took
+int solveHierarchy(Vector<LevelData<FArrayBox>* >& a_phi,
+                   Vector<LevelData<FArrayBox>* >& a_rhs,
+                   const Vector<DisjointBoxLayout>& a_grids,
+                   const Vector<int>&               a_refRatios,
+                   const ProblemDomain&             a_domain,
+                   int                              a_krylov,
+                   int&                             a_numVCycles)
+{
+  AMRPoissonOpFactory opFactory;
+  opFactory.define(a_domain, a_grids, a_refRatios, dx, DirParabolaBC);
+
+  BiCGStabSolver<LevelData<FArrayBox> > bottomSolver;
+  bottomSolver.m_verbosity = 0;
+
+  AMRMultiGrid<LevelData<FArrayBox> > solver;
+  solver.define(a_domain, opFactory, &bottomSolver, a_grids.size());
+  solver.setSolverParameters(2, 2, 2, 1, 40, 1.0e-10, 1.0e-15, 1.0e-30);
+  solver.setKrylovMethod(a_krylov, 10);
+  solver.m_verbosity = verbose ? 2 : 0;
+
+  solver.solve(a_phi, a_rhs, a_grids.size()-1, 0);
+  a_numVCycles = solver.m_numVCycles;
+  return solver.m_exitStatus;
+}
+
+int
+testKrylovAMRMultiGrid()
+{
+  ProblemDomain domain(Box(IntVect::Zero, (nCells-1)*IntVect::Unit));
+  Vector<DisjointBoxLayout> grids;
+  Vector<int> refRatios;
+  makeHierarchy(grids, refRatios, domain);
+  int numLevels = grids.size();
+
+  const int numMethods = 3;
+  int methods[numMethods] =
+  {
+    AMRMultiGrid<LevelData<FArrayBox> >::noKrylov,
+    AMRMultiGrid<LevelData<FArrayBox> >::bicgstabKrylov,
+    AMRMultiGrid<LevelData<FArrayBox> >::gmresKrylov
+  };
+  const char* names[numMethods] = {"V-cycles", "bicgstab", "gmres"};
+
+  Vector<LevelData<FArrayBox>* > rhs(numLevels);
+  Vector<Vector<LevelData<FArrayBox>* > > phi(numMethods, Vector<LevelData<FArrayBox>* >(numLevels));
+  for (int ilev = 0; ilev < numLevels; ilev++)
+    {
+      rhs[ilev] = new LevelData<FArrayBox>(grids[ilev], 1, IntVect::Zero);
+      for (DataIterator dit = grids[ilev].dataIterator(); dit.ok(); ++dit)
+        {
+          //a bump in the source that straddles the coarse-fine interface
+          Real dxLev = (ilev == 0) ? dx : dx/refRatios[0];
+          FArrayBox& rhsFAB = (*rhs[ilev])[dit()];
+          for (BoxIterator bit(grids[ilev].get(dit())); bit.ok(); ++bit)
+            {
+              RealVect x = dxLev*(RealVect(bit()) + 0.5*RealVect::Unit);
+              rhsFAB(bit(), 0) = 2*CH_SPACEDIM + 10.0*exp(-50.0*(x - 0.3*RealVect::Unit).dotProduct(x - 0.3*RealVect::Unit));
+            }
+        }
+      for (int imeth = 0; imeth < numMethods; imeth++)
+        {
+          phi[imeth][ilev] = new LevelData<FArrayBox>(grids[ilev], 1, IntVect::Unit);
+        }
+    }
+
+  int status = 0;
+  for (int imeth = 0; imeth < numMethods; imeth++)
+    {
+      int numVCycles;
+      int exitStatus = solveHierarchy(phi[imeth], rhs, grids, refRatios, domain,
+                                      methods[imeth], numVCycles);
+      if (verbose)
+        {
+          pout() << indent2 << names[imeth] << ": " << numVCycles
+                 << " V-cycles, exit status " << exitStatus << endl;
+        }
+      //bit one means the residual was reduced to the tolerance
+      if ((exitStatus & 1) == 0)
+        {
+          pout() << indent2 << names[imeth] << " did not converge" << endl;
+          status += 1;
+        }
+    }
+
+  //all of them solve the same composite problem
+  for (int imeth = 1; imeth < numMethods; imeth++)
+    {
+      Real maxDiff = 0, maxPhi = 0;
+      for (int ilev = 0; ilev < numLevels; ilev++)
+        {
+          for (DataIterator dit = grids[ilev].dataIterator(); dit.ok(); ++dit)
+            {
+              const Box& box = grids[ilev].get(dit());
+              FArrayBox diff(box, 1);
+              diff.copy((*phi[imeth][ilev])[dit()]);
+              diff.minus((*phi[0][ilev])[dit()]);
+              maxDiff = Max(maxDiff, diff.norm(box, 0));
+              maxPhi  = Max(maxPhi, (*phi[0][ilev])[dit()].norm(box, 0));
+            }
+        }
+#ifdef CH_MPI
+      Real localDiff = maxDiff;
+      MPI_Allreduce(&localDiff, &maxDiff, 1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+      Real localPhi = maxPhi;
+      MPI_Allreduce(&localPhi, &maxPhi, 1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+#endif
+      if (verbose)
+        {
+          pout() << indent2 << names[imeth] << ": max difference from V-cycles = " << maxDiff << endl;
+        }
+      if (maxDiff > 1.0e-6*maxPhi)
+        {
+          pout() << indent2 << names[imeth] << " solution differs by " << maxDiff << endl;
+          status += 10;
+        }
+    }
+
+  for (int ilev = 0; ilev < numLevels; ilev++)
+    {
+      delete rhs[ilev];
+      for (int imeth = 0; imeth < numMethods; imeth++)
+        {
+          delete phi[imeth][ilev];
+        }
+    }
+  return status;
+}
+
+int
+main(int argc ,char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init (&argc, &argv);
+#endif
+
+  parseTestOptions( argc ,argv ) ;
+  if ( verbose )
+    pout () << indent2 << "Beginning " << pgmname << " ..." << endl ;
+
+  int status = testKrylovAMRMultiGrid();
+
+  if ( status == 0 )
+  {
+    pout() << indent << pgmname << " passed." << endl ;
+  }
+  else
+  {
+    pout() << indent << pgmname << " failed with return code " << status << endl ;
+  }
+
+#ifdef CH_MPI
+  MPI_Finalize ();
+#endif
+  return status;
+}
@@ -39,6 +39,7 @@ test();
 static const char *pgmname = "HDF5data" ;
 static const char *indent = "   ", *indent2 = "      " ;
 static bool verbose = true ;
+static bool floatOutput = false ;
 
 /// Code:
 
@@ -58,6 +59,28 @@ main(int argc, char* argv[])
   // Run the tests
   ///
   int icode = test();
+#ifdef CH_USE_HDF5
+  if (icode == 0)
+    {
+      // again, with all the boxes of a processor in one write
+      HDF5Handle::setAggregatedWrite(true);
+      icode = test();
+      HDF5Handle::setAggregatedWrite(false);
+    }
+  if (icode == 0)
+    {
+      // and with small compressed chunks
+      HDF5Handle::setCompression(6, true, 7);
+      icode = test();
+      HDF5Handle::setCompression(0);
+    }
+  if (icode == 0)
+    {
+      // and with the Real data stored in single precision
+      floatOutput = true;
+      icode = test();
+    }
+#endif
   if (icode != 0)
     {
       pout() << indent << pgmname <<" failed"<<endl;
@@ -142,6 +165,7 @@ int test()
     }
 
   CH_assert(testFile.isOpen());
+  testFile.setFloatOutput(floatOutput);
 
   Box domain(IntVect::Zero, 20*IntVect::Unit);
 
@@ -427,6 +451,28 @@ int test()
       return error;
     }
 
+  // the level data may have gone through single precision on the way
+  Real tolerance = floatOutput ? 1.0e-6 : 0.0;
+  for (DataIterator dit(readState.dataIterator()); dit.ok(); ++dit)
+    {
+      const Box& box = readState.box(dit());
+      FArrayBox expected(box, readState.nComp());
+      values::setVal3(box, readState.nComp(), expected);
+      for (int c=0; c<readState.nComp(); ++c)
+        {
+          for (BoxIterator it(box); it.ok(); ++it)
+            {
+              Real diff = Abs(readState[dit()](it(), c) - expected(it(), c));
+              if (diff > tolerance*Abs(expected(it(), c)))
+                {
+                  if ( verbose )
+                    pout() << indent2 << "readState != state, off by "<<diff<<endl;
+                  return 4;
+                }
+            }
+        }
+    }
+
 #ifndef CH_MPI
   // OK, now try to read one FArrayBox at a time
   // problem with DataIterator and running the out-of-core in parallel, so
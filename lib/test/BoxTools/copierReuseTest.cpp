@@ -0,0 +1,238 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+
+#include <cstring>
+
+#include "REAL.H"
+#include "Vector.H"
+#include "DataIterator.H"
+#include "DisjointBoxLayout.H"
+#include "ProblemDomain.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "BoxIterator.H"
+#include "LevelData.H"
+#include "FArrayBox.H"
+#include "BaseFab.H"
+#include "Copier.H"
+#include "SharedMemoryExchange.H"
+
+#ifdef CH_MPI
+#include <mpi.h>
+#endif
+#include "UsingNamespace.H"
+
+/// Prototypes:
+void
+parseTestOptions( int argc ,char* argv[] );
+
+int testCopierReuse(void);
+
+/// Global variables for handling output:
+static const char *pgmname = "copierReuseTest";
+static const char *indent2 = "      ";
+static bool verbose = true;
+
+/// Code:
+int main(int argc, char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions(argc,argv);
+
+  if ( verbose ) pout() << indent2 << "Beginning " << pgmname << " ..." << endl;
+
+  int ret = testCopierReuse();
+  if (ret == 0)
+    {
+      pout() << "copier reuse test passed" << endl;
+    }
+  else
+    {
+      pout() << "copier reuse test failed with code " << ret << endl;
+    }
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+
+  return ret;
+}
+
+static int exactValue(const IntVect& a_iv, int a_comp, int a_pass)
+{
+  return D_TERM(a_iv[0], + 100*a_iv[1], + 10000*a_iv[2]) + 7*a_comp + 1000000*a_pass;
+}
+
+template <class T>
+static void setValid(LevelData<T>& a_data, int a_pass)
+{
+  const DisjointBoxLayout& grids = a_data.disjointBoxLayout();
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      a_data[dit()].setVal(-1);
+      for (BoxIterator bit(grids[dit()]); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < a_data.nComp(); comp++)
+            {
+              a_data[dit()](bit(), comp) = exactValue(bit(), comp, a_pass);
+            }
+        }
+    }
+}
+
+//a_data has to hold component a_comp0 + comp of pass a_pass in its valid cells
+template <class T>
+static int checkData(const LevelData<T>& a_data, int a_pass, int a_comp0)
+{
+  const DisjointBoxLayout& grids = a_data.disjointBoxLayout();
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      for (BoxIterator bit(grids[dit()]); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < a_data.nComp(); comp++)
+            {
+              if (a_data[dit()](bit(), comp) != exactValue(bit(), a_comp0 + comp, a_pass))
+                {
+                  pout() << "pass " << a_pass << ": value at " << bit()
+                         << " comp " << comp << " looks wrong" << endl;
+                  return 1;
+                }
+            }
+        }
+    }
+  return 0;
+}
+
+//one Copier used over and over for data of different types and numbers
+//of components, whose buffers and requests have to follow along
+static int runCopies(const DisjointBoxLayout& a_grids,
+                     const DisjointBoxLayout& a_otherGrids)
+{
+  int status = 0;
+  LevelData<FArrayBox>    data(a_grids, 2);
+  LevelData<FArrayBox>    other(a_otherGrids, 2);
+  LevelData<FArrayBox>    otherOne(a_otherGrids, 1);
+  LevelData<BaseFab<int> > intData(a_grids, 2);
+  LevelData<BaseFab<int> > intOther(a_otherGrids, 2);
+  Copier copier(a_grids, a_otherGrids);
+  for (int pass = 0; pass < 12; pass++)
+    {
+      switch (pass%4)
+        {
+        case 0:
+          setValid(intData, pass);
+          intData.copyTo(intData.interval(), intOther, intOther.interval(), copier);
+          status += checkData(intOther, pass, 0);
+          break;
+        case 1:
+        case 2:
+          //same number of components, twice the bytes
+          setValid(data, pass);
+          data.copyTo(data.interval(), other, other.interval(), copier);
+          status += checkData(other, pass, 0);
+          break;
+        case 3:
+          setValid(data, pass);
+          data.copyTo(Interval(1,1), otherOne, Interval(0,0), copier);
+          status += checkData(otherOne, pass, 1);
+          break;
+        }
+#ifdef CH_MPI
+      //the second of two alike copies reuses the requests of the first
+      static std::vector<MPI_Request> s_sends, s_receives;
+      if (pass%4 == 1)
+        {
+          s_sends    = copier.m_buffers.m_persistentSends;
+          s_receives = copier.m_buffers.m_persistentReceives;
+        }
+      if (pass%4 == 2 && (copier.m_buffers.m_persistentSends    != s_sends ||
+                          copier.m_buffers.m_persistentReceives != s_receives ||
+                          (numProc() > 1 && s_receives.size() == 0)))
+        {
+          pout() << "pass " << pass << ": persistent requests were not reused" << endl;
+          status++;
+        }
+#endif
+    }
+  return status;
+}
+
+int testCopierReuse(void)
+{
+  int domsize = 64;
+  Box bigBox(IntVect::Zero, (domsize-1)*IntVect::Unit);
+  ProblemDomain domain(bigBox);
+  Vector<Box> boxes;
+  domainSplit(domain, boxes, 8, 8);
+  Vector<int> ranks;
+  LoadBalance(ranks, boxes);
+  DisjointBoxLayout grids(boxes, ranks, domain);
+
+  Vector<Box> otherBoxes;
+  domainSplit(domain, otherBoxes, 16, 16);
+  Vector<int> otherRanks;
+  LoadBalance(otherRanks, otherBoxes);
+  for (int i = 0; i < otherRanks.size(); i++)
+    {
+      otherRanks[i] = numProc() - 1 - otherRanks[i];
+    }
+  DisjointBoxLayout otherGrids(otherBoxes, otherRanks, domain);
+
+  //with plain messages, then with the on-node data in shared segments
+  for (int shared = 0; shared < 2; shared++)
+    {
+      if (shared) SharedMemoryExchange::define(1 << 22);
+      int status = runCopies(grids, otherGrids);
+      SharedMemoryExchange::clear();
+      if (status != 0)
+        {
+          pout() << indent2 << "shared " << shared << ": " << status << " bad checks" << endl;
+          return -10 - shared;
+        }
+      if (verbose)
+        {
+          pout() << indent2 << "shared " << shared << " ok" << endl;
+        }
+    }
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q) out of the command line.
+// Stop parsing when a non-option argument is found.
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+  {
+    if ( argv[i][0] == '-' ) //if it is an option
+    {
+      // compare 3 chars to differentiate -x from -xx
+      if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+      {
+        verbose = true ;
+        // argv[i] = "" ;
+      }
+      else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+      {
+        verbose = false ;
+        // argv[i] = "" ;
+      }
+      else
+      {
+        break ;
+      }
+    }
+  }
+  return ;
+}
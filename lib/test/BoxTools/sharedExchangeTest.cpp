@@ -0,0 +1,211 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+
+#include <cstring>
+
+#include "REAL.H"
+#include "Vector.H"
+#include "DataIterator.H"
+#include "DisjointBoxLayout.H"
+#include "ProblemDomain.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "BoxIterator.H"
+#include "LevelData.H"
+#include "FArrayBox.H"
+#include "SharedMemoryExchange.H"
+
+#ifdef CH_MPI
+#include <mpi.h>
+#endif
+#include "UsingNamespace.H"
+
+/// Prototypes:
+void
+parseTestOptions( int argc ,char* argv[] );
+
+int testSharedExchange(void);
+
+/// Global variables for handling output:
+static const char *pgmname = "sharedExchangeTest";
+static const char *indent2 = "      ";
+static bool verbose = true;
+
+/// Code:
+int main(int argc, char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  parseTestOptions(argc,argv);
+
+  if ( verbose ) pout() << indent2 << "Beginning " << pgmname << " ..." << endl;
+
+  int ret = testSharedExchange();
+  if (ret == 0)
+    {
+      pout() << "shared exchange test passed" << endl;
+    }
+  else
+    {
+      pout() << "shared exchange test failed with code " << ret << endl;
+    }
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+
+  return ret;
+}
+
+static Real exactValue(const IntVect& a_iv, int a_comp, int a_pass)
+{
+  return D_TERM(a_iv[0], + 100*a_iv[1], + 10000*a_iv[2]) + 0.25*a_comp + 1000000*a_pass;
+}
+
+static void setValid(LevelData<FArrayBox>& a_data, int a_pass)
+{
+  const DisjointBoxLayout& grids = a_data.disjointBoxLayout();
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      a_data[dit()].setVal(-1.0);
+      for (BoxIterator bit(grids[dit()]); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < a_data.nComp(); comp++)
+            {
+              a_data[dit()](bit(), comp) = exactValue(bit(), comp, a_pass);
+            }
+        }
+    }
+}
+
+//every cell of a_region of every box must hold pass a_pass
+static int checkData(const LevelData<FArrayBox>& a_data, int a_pass, bool a_ghosts)
+{
+  const DisjointBoxLayout& grids = a_data.disjointBoxLayout();
+  const Box& domain = grids.physDomain().domainBox();
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      Box region = a_ghosts ? a_data[dit()].box() : grids[dit()];
+      region &= domain;
+      for (BoxIterator bit(region); bit.ok(); ++bit)
+        {
+          for (int comp = 0; comp < a_data.nComp(); comp++)
+            {
+              if (a_data[dit()](bit(), comp) != exactValue(bit(), comp, a_pass))
+                {
+                  pout() << "value at " << bit() << " comp " << comp << " looks wrong" << endl;
+                  return 1;
+                }
+            }
+        }
+    }
+  return 0;
+}
+
+//exchanges and copies with the given segment size (0 = plain messages)
+static int runExchanges(const DisjointBoxLayout& a_grids,
+                        const DisjointBoxLayout& a_otherGrids,
+                        size_t a_segmentSize)
+{
+  if (a_segmentSize > 0)
+    {
+      SharedMemoryExchange::define(a_segmentSize);
+    }
+  int status = 0;
+  {
+    LevelData<FArrayBox> data(a_grids, 2, 2*IntVect::Unit);
+    LevelData<FArrayBox> other(a_otherGrids, 2, IntVect::Zero);
+    Copier copier(a_grids, a_otherGrids);
+    //the buffers are reused, so the data has to change from pass to pass
+    for (int pass = 0; pass < 3; pass++)
+      {
+        setValid(data, pass);
+        data.exchange();
+        status += checkData(data, pass, true);
+        data.copyTo(data.interval(), other, other.interval(), copier);
+        status += checkData(other, pass, false);
+      }
+  }
+  SharedMemoryExchange::clear();
+  return status;
+}
+
+int testSharedExchange(void)
+{
+  int domsize = 64;
+  Box bigBox(IntVect::Zero, (domsize-1)*IntVect::Unit);
+  ProblemDomain domain(bigBox);
+  Vector<Box> boxes;
+  domainSplit(domain, boxes, 8, 8);
+  Vector<int> ranks;
+  LoadBalance(ranks, boxes);
+  DisjointBoxLayout grids(boxes, ranks, domain);
+
+  //same index space, different boxes and ranks for the copies
+  Vector<Box> otherBoxes;
+  domainSplit(domain, otherBoxes, 16, 16);
+  Vector<int> otherRanks;
+  LoadBalance(otherRanks, otherBoxes);
+  for (int i = 0; i < otherRanks.size(); i++)
+    {
+      otherRanks[i] = numProc() - 1 - otherRanks[i];
+    }
+  DisjointBoxLayout otherGrids(otherBoxes, otherRanks, domain);
+
+  //plain messages, in the shared segments, and a segment too small to hold
+  //anything, which falls back to messages
+  size_t sizes[3] = {0, 1 << 22, 64};
+  for (int i = 0; i < 3; i++)
+    {
+      int status = runExchanges(grids, otherGrids, sizes[i]);
+      if (status != 0)
+        {
+          pout() << indent2 << "segment size " << sizes[i] << ": " << status << " bad checks" << endl;
+          return -10 - i;
+        }
+      if (verbose)
+        {
+          pout() << indent2 << "segment size " << sizes[i] << " ok" << endl;
+        }
+    }
+  return 0;
+}
+
+///
+// Parse the standard test options (-v -q) out of the command line.
+// Stop parsing when a non-option argument is found.
+///
+void
+parseTestOptions( int argc ,char* argv[] )
+{
+  for ( int i = 1 ; i < argc ; ++i )
+  {
+    if ( argv[i][0] == '-' ) //if it is an option
+    {
+      // compare 3 chars to differentiate -x from -xx
+      if ( strncmp( argv[i] ,"-v" ,3 ) == 0 )
+      {
+        verbose = true ;
+        // argv[i] = "" ;
+      }
+      else if ( strncmp( argv[i] ,"-q" ,3 ) == 0 )
+      {
+        verbose = false ;
+        // argv[i] = "" ;
+      }
+      else
+      {
+        break ;
+      }
+    }
+  }
+  return ;
+}
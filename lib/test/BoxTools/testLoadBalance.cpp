@@ -23,6 +23,7 @@
 #include "SPMD.H"  // to get num_procs global variable
 #include "LoadBalance.H"
 #include "Misc.H"
+#include "BRMeshRefine.H"
 #include "parstream.H"
 #include "UsingNamespace.H"
 
@@ -35,6 +36,10 @@ int
 testLB3(void);
 int
 testLB4(void);
+int
+testLB5(void);
+int
+testLB6(void);
 
 using std::endl;
 
@@ -107,6 +112,30 @@ main(int argc ,char* argv[])
     stat_all = status ;
   }
 
+  status = testLB5();
+
+  if ( status == 0 )
+  {
+    if ( verbose ) pout() << indent << pgmname << " passed test 5." << endl ;
+  }
+  else
+  {
+    pout() << indent << pgmname << " failed test 5 with return code " << status << endl ;
+    stat_all = status ;
+  }
+
+  status = testLB6();
+
+  if ( status == 0 )
+  {
+    if ( verbose ) pout() << indent << pgmname << " passed test 6." << endl ;
+  }
+  else
+  {
+    pout() << indent << pgmname << " failed test 6 with return code " << status << endl ;
+    stat_all = status ;
+  }
+
   if ( stat_all == 0 )
     pout() << indent << pgmname << ": passed all tests." << endl ;
   else
@@ -997,6 +1026,188 @@ testLB4()
   return 0 ;
 }
 
+// cells of the fine boxes that sit over coarse cells of the same rank
+long long
+alignedCells(const Vector<Box>& a_fine, const Vector<int>& a_fineProcs,
+             const Vector<Box>& a_coar, const Vector<int>& a_coarProcs, int a_ref)
+{
+  long long aligned = 0;
+  for (int i = 0; i < a_fine.size(); ++i)
+    {
+      for (int j = 0; j < a_coar.size(); ++j)
+        {
+          Box inter = a_fine[i] & refine(a_coar[j], a_ref);
+          if (!inter.isEmpty() && a_fineProcs[i] == a_coarProcs[j])
+            {
+              aligned += inter.numPts();
+            }
+        }
+    }
+  return aligned;
+}
+
+// SFCLoadBalance: contiguous chunks of the Morton order, each within a
+// box of the goal, and a fine level that lines up with its parents
+int
+testLB5()
+{
+  const int numProcs = 4;
+  const int ref = 2;
+  Vector<Box> coarBoxes;
+  domainSplit(Box(IntVect::Zero, 63*IntVect::Unit), coarBoxes, 16, 4);
+  mortonOrdering(coarBoxes);
+  Vector<long long> coarLoads(coarBoxes.size());
+  long long maxLoad = 0;
+  for (int i = 0; i < coarBoxes.size(); ++i)
+    {
+      coarLoads[i] = coarBoxes[i].numPts();
+      maxLoad = Max(maxLoad, coarLoads[i]);
+    }
+  Vector<int> coarProcs;
+  int status = SFCLoadBalance(coarProcs, coarLoads, coarBoxes,
+                              Vector<Box>(), Vector<int>(), ref, numProcs);
+  if (status != 0) return status;
+
+  Vector<long long> procLoads(numProcs, 0);
+  long long totalLoad = 0;
+  for (int i = 0; i < coarBoxes.size(); ++i)
+    {
+      if (coarProcs[i] < 0 || coarProcs[i] >= numProcs)
+        {
+          if (verbose) pout() << indent2 << "test5: assignment " << coarProcs[i] << " out of range" << endl;
+          return -521;
+        }
+      if (i > 0 && coarProcs[i] < coarProcs[i-1])
+        {
+          if (verbose) pout() << indent2 << "test5: coarse chunks are not contiguous" << endl;
+          return -522;
+        }
+      procLoads[coarProcs[i]] += coarLoads[i];
+      totalLoad += coarLoads[i];
+    }
+  for (int iproc = 0; iproc < numProcs; ++iproc)
+    {
+      if (Abs(procLoads[iproc] - totalLoad/numProcs) > maxLoad)
+        {
+          if (verbose) pout() << indent2 << "test5: load " << procLoads[iproc]
+                              << " on proc " << iproc << " is off the goal" << endl;
+          return -523;
+        }
+    }
+
+  //fine level over the upper half, where chunk order and rank order disagree
+  Box fineRegion(IntVect::Zero, 63*IntVect::Unit);
+  fineRegion.setSmall(SpaceDim-1, 32);
+  fineRegion.refine(ref);
+  Vector<Box> fineBoxes;
+  domainSplit(fineRegion, fineBoxes, 16, 4);
+  mortonOrdering(fineBoxes);
+  Vector<long long> fineLoads(fineBoxes.size());
+  for (int i = 0; i < fineBoxes.size(); ++i)
+    {
+      fineLoads[i] = fineBoxes[i].numPts();
+    }
+  Vector<int> plainProcs, fineProcs;
+  SFCLoadBalance(plainProcs, fineLoads, fineBoxes, Vector<Box>(), Vector<int>(), ref, numProcs);
+  status = SFCLoadBalance(fineProcs, fineLoads, fineBoxes, coarBoxes, coarProcs, ref, numProcs);
+  if (status != 0) return status;
+
+  //same chunks, only the ranks they go to may differ
+  Vector<int> chunkProc(numProcs, -1), procChunk(numProcs, -1);
+  for (int i = 0; i < fineBoxes.size(); ++i)
+    {
+      int chunk = plainProcs[i];
+      int proc  = fineProcs[i];
+      if ((chunkProc[chunk] >= 0 && chunkProc[chunk] != proc) ||
+          (procChunk[proc]  >= 0 && procChunk[proc]  != chunk))
+        {
+          if (verbose) pout() << indent2 << "test5: fine ranks are not a relabelling of the chunks" << endl;
+          return -524;
+        }
+      chunkProc[chunk] = proc;
+      procChunk[proc]  = chunk;
+    }
+
+  long long plainAligned = alignedCells(fineBoxes, plainProcs, coarBoxes, coarProcs, ref);
+  long long aligned      = alignedCells(fineBoxes, fineProcs,  coarBoxes, coarProcs, ref);
+  if (verbose)
+    {
+      pout() << indent2 << "test5: " << fineRegion.numPts() << " fine cells, "
+             << aligned << " over their own rank (" << plainAligned << " without alignment)" << endl;
+    }
+  if (aligned < plainAligned || aligned == 0)
+    {
+      return -525;
+    }
+
+  return 0 ;
+}
+
+// with ranks placed round robin on two nodes, the first half of the
+// Morton order must land on one node and the second half on the other
+int
+testLB6()
+{
+  const int numProcs = 8;
+  Vector<int> rankNodes(numProcs);
+  for (int iproc = 0; iproc < numProcs; ++iproc)
+    {
+      rankNodes[iproc] = iproc%2;
+    }
+  setRankNodes(rankNodes);
+
+  Vector<Box> boxes;
+  domainSplit(Box(IntVect::Zero, 63*IntVect::Unit), boxes, 16, 4);
+  mortonOrdering(boxes);
+  Vector<long long> loads(boxes.size());
+  for (int i = 0; i < boxes.size(); ++i)
+    {
+      loads[i] = boxes[i].numPts();
+    }
+
+  int status = 0;
+  for (int ibalance = 0; ibalance < 2 && status == 0; ++ibalance)
+    {
+      Vector<int> procs;
+      if (ibalance == 0)
+        {
+          LoadBalance(procs, loads, boxes, numProcs);
+        }
+      else
+        {
+          SFCLoadBalance(procs, loads, boxes, Vector<Box>(), Vector<int>(), 2, numProcs);
+        }
+      Vector<int> used(numProcs, 0);
+      for (int i = 0; i < boxes.size(); ++i)
+        {
+          used[procs[i]] = 1;
+          int node = (i < boxes.size()/2) ? 0 : 1;
+          if (rankNodes[procs[i]] != node)
+            {
+              if (verbose) pout() << indent2 << "test6: box " << i << " on rank " << procs[i]
+                                  << " of node " << rankNodes[procs[i]] << endl;
+              status = -621 - ibalance;
+              break;
+            }
+        }
+      for (int iproc = 0; iproc < numProcs; ++iproc)
+        {
+          if (!used[iproc]) status = -623;
+        }
+    }
+
+  setRankNodes(Vector<int>());
+  if (status == 0)
+    {
+      //detection always finds at least one node and covers every rank
+      Vector<int> detected;
+      int numNodes = detectRankNodes(detected, 1);
+      if (numNodes < 1 || detected.size() != numProc()) status = -624;
+      if (verbose) pout() << indent2 << "test6: detected " << numNodes << " socket groups" << endl;
+    }
+  return status;
+}
+
 ///
 // Parse the standard test options (-v -q) out of the command line.
 ///
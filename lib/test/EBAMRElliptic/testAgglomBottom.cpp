@@ -0,0 +1,289 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <cmath>
+#include <cstring>
+
+#include "EBIndexSpace.H"
+#include "AllRegularService.H"
+#include "EBISLayout.H"
+#include "EBCellFactory.H"
+#include "BoxIterator.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "EBAgglomeratedSolver.H"
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testAgglomBottom" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = false ;
+
+///
+/**
+   Nonsymmetric two-component operator with a stencil of radius two,
+   zero outside the domain in the directions that are not periodic.
+ */
+class TwoCompOp : public LinearOp<LevelData<EBCellFAB> >
+{
+public:
+  TwoCompOp(const EBISLayout& a_ebisl, const ProblemDomain& a_domain)
+    :m_ebisl(a_ebisl), m_domain(a_domain), m_diagonal(-4.5)
+  {
+  }
+
+  void setDiagonal(Real a_diagonal)
+  {
+    m_diagonal = a_diagonal;
+  }
+
+  virtual void applyOp(LevelData<EBCellFAB>&       a_lhs,
+                       const LevelData<EBCellFAB>& a_phi,
+                       bool                        a_homogeneous)
+  {
+    LevelData<EBCellFAB>& phi = (LevelData<EBCellFAB>&) a_phi;
+    phi.exchange();
+    for (DataIterator dit = phi.dataIterator(); dit.ok(); ++dit)
+      {
+        const EBCellFAB& phiFAB = phi[dit()];
+        for (BoxIterator bit(phi.disjointBoxLayout().get(dit())); bit.ok(); ++bit)
+          {
+            const IntVect& iv = bit();
+            for (int icomp = 0; icomp < 2; icomp++)
+              {
+                Real lph = m_diagonal*value(phiFAB, iv, icomp);
+                lph += value(phiFAB, iv + BASISV(0), icomp) + 0.8*value(phiFAB, iv - BASISV(0), icomp);
+                for (int idir = 1; idir < SpaceDim; idir++)
+                  {
+                    lph += value(phiFAB, iv + BASISV(idir), icomp) + value(phiFAB, iv - BASISV(idir), icomp);
+                  }
+                lph += 0.3*value(phiFAB, iv + 2*BASISV(0), 1-icomp);
+                a_lhs[dit()](VolIndex(iv, 0), icomp) = lph;
+              }
+          }
+      }
+  }
+
+  virtual void create(LevelData<EBCellFAB>&       a_lhs,
+                      const LevelData<EBCellFAB>& a_rhs)
+  {
+    EBCellFactory fact(m_ebisl);
+    a_lhs.define(a_rhs.disjointBoxLayout(), a_rhs.nComp(), a_rhs.ghostVect(), fact);
+  }
+
+  virtual void setToZero(LevelData<EBCellFAB>& a_lhs)
+  {
+    for (DataIterator dit = a_lhs.dataIterator(); dit.ok(); ++dit)
+      {
+        a_lhs[dit()].setVal(0.0);
+      }
+  }
+
+  //not needed by the agglomerated solver
+  virtual void residual(LevelData<EBCellFAB>& a_lhs, const LevelData<EBCellFAB>& a_phi,
+                        const LevelData<EBCellFAB>& a_rhs, bool a_homogeneous)
+  {
+    MayDay::Error("TwoCompOp::residual not implemented");
+  }
+  virtual void preCond(LevelData<EBCellFAB>& a_cor, const LevelData<EBCellFAB>& a_residual)
+  {
+    MayDay::Error("TwoCompOp::preCond not implemented");
+  }
+  virtual void assign(LevelData<EBCellFAB>& a_lhs, const LevelData<EBCellFAB>& a_rhs)
+  {
+    MayDay::Error("TwoCompOp::assign not implemented");
+  }
+  virtual Real dotProduct(const LevelData<EBCellFAB>& a_1, const LevelData<EBCellFAB>& a_2)
+  {
+    MayDay::Error("TwoCompOp::dotProduct not implemented");
+    return 0.;
+  }
+  virtual void incr(LevelData<EBCellFAB>& a_lhs, const LevelData<EBCellFAB>& a_x, Real a_scale)
+  {
+    MayDay::Error("TwoCompOp::incr not implemented");
+  }
+  virtual void axby(LevelData<EBCellFAB>& a_lhs, const LevelData<EBCellFAB>& a_x,
+                    const LevelData<EBCellFAB>& a_y, Real a_a, Real a_b)
+  {
+    MayDay::Error("TwoCompOp::axby not implemented");
+  }
+  virtual void scale(LevelData<EBCellFAB>& a_lhs, const Real& a_scale)
+  {
+    MayDay::Error("TwoCompOp::scale not implemented");
+  }
+  virtual Real norm(const LevelData<EBCellFAB>& a_rhs, int a_ord)
+  {
+    MayDay::Error("TwoCompOp::norm not implemented");
+    return 0.;
+  }
+
+private:
+  Real value(const EBCellFAB& a_phi, const IntVect& a_iv, int a_comp) const
+  {
+    const Box& domainBox = m_domain.domainBox();
+    for (int idir = 0; idir < SpaceDim; idir++)
+      {
+        if (!m_domain.isPeriodic(idir) &&
+            ((a_iv[idir] < domainBox.smallEnd(idir)) || (a_iv[idir] > domainBox.bigEnd(idir))))
+          {
+            return 0.;
+          }
+      }
+    return a_phi.getSingleValuedFAB()(a_iv, a_comp);
+  }
+
+  EBISLayout    m_ebisl;
+  ProblemDomain m_domain;
+  Real          m_diagonal;
+};
+
+/***************/
+int
+agglomTest(bool a_periodic)
+{
+  //12 cells in x so a period of six survives the periodic wrap
+  IntVect hiEnd = 7*IntVect::Unit;
+  hiEnd[0] = 11;
+  bool isPeriodic[SpaceDim];
+  for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      isPeriodic[idir] = (a_periodic && (idir == 0));
+    }
+  ProblemDomain domain(Box(IntVect::Zero, hiEnd), isPeriodic);
+
+  Vector<Box> boxes;
+  domainSplit(domain, boxes, 6, 2);
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout grids(boxes, procs, domain);
+
+  EBIndexSpace* ebisPtr = Chombo_EBIS::instance();
+  AllRegularService service;
+  ebisPtr->define(domain, RealVect::Zero, 1.0, service);
+  EBISLayout ebisl;
+  ebisPtr->fillEBISLayout(ebisl, grids, domain, 4);
+
+  EBCellFactory fact(ebisl);
+  IntVect ghost = 2*IntVect::Unit;
+  LevelData<EBCellFAB> phi(grids, 2, ghost, fact);
+  LevelData<EBCellFAB> rhs(grids, 2, ghost, fact);
+  LevelData<EBCellFAB> lph(grids, 2, ghost, fact);
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      phi[dit()].setVal(0.0);
+      rhs[dit()].setVal(0.0);
+      for (BoxIterator bit(grids.get(dit())); bit.ok(); ++bit)
+        {
+          const IntVect& iv = bit();
+          for (int icomp = 0; icomp < 2; icomp++)
+            {
+              rhs[dit()](VolIndex(iv, 0), icomp) = sin(0.3*iv[0] + 1.7*icomp) + 0.1*iv[1]*iv[1];
+            }
+        }
+    }
+
+  TwoCompOp op(ebisl, domain);
+  EBAgglomeratedSolver solver;
+  solver.define(&op, true);
+  solver.solve(phi, rhs);
+  if (!solver.isAgglomerated())
+    {
+      pout() << indent2 << "bottom problem was not agglomerated" << endl;
+      return -1;
+    }
+
+  //same operator: the factorization is reused
+  solver.define(&op, true);
+  solver.solve(phi, rhs);
+  if (solver.numBuilds() != 1)
+    {
+      pout() << indent2 << "matrix rebuilt for an unchanged operator" << endl;
+      return -3;
+    }
+  //new coefficients: it is rebuilt, and the check below uses them
+  op.setDiagonal(-5.0);
+  solver.define(&op, true);
+  solver.solve(phi, rhs);
+  if (solver.numBuilds() != 2)
+    {
+      pout() << indent2 << "matrix not rebuilt after the operator changed" << endl;
+      return -4;
+    }
+
+  //L(phi) should reproduce rhs to roundoff
+  op.applyOp(lph, phi, true);
+  Real maxDiff = 0, maxRHS = 0;
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      for (BoxIterator bit(grids.get(dit())); bit.ok(); ++bit)
+        {
+          VolIndex vof(bit(), 0);
+          for (int icomp = 0; icomp < 2; icomp++)
+            {
+              maxDiff = Max(maxDiff, Abs(lph[dit()](vof, icomp) - rhs[dit()](vof, icomp)));
+              maxRHS  = Max(maxRHS,  Abs(rhs[dit()](vof, icomp)));
+            }
+        }
+    }
+#ifdef CH_MPI
+  Real localDiff = maxDiff;
+  MPI_Allreduce(&localDiff, &maxDiff, 1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+  Real localRHS = maxRHS;
+  MPI_Allreduce(&localRHS, &maxRHS, 1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+#endif
+  if (verbose)
+    {
+      pout() << indent2 << "periodic = " << a_periodic << ", unknowns = " << solver.numUnknowns()
+             << ", max |L(phi) - rhs| = " << maxDiff << endl;
+    }
+  Chombo_EBIS::instance()->clear();
+  if (maxDiff > 1.0e-10*maxRHS)
+    {
+      pout() << indent2 << "residual too large: " << maxDiff << endl;
+      return -2;
+    }
+  return 0;
+}
+/***************/
+int
+main(int argc, char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  //scoping trick
+  {
+    for (int iarg = 1; iarg < argc; iarg++)
+      {
+        if (strncmp(argv[iarg], "-v", 3) == 0)
+          {
+            verbose = true;
+          }
+      }
+    int eekflag = agglomTest(false);
+    if (eekflag == 0)
+      {
+        eekflag = agglomTest(true);
+      }
+    if (eekflag == 0)
+      {
+        pout() << indent << pgmname << " passed." << endl;
+      }
+    else
+      {
+        pout() << indent << pgmname << " failed with error code " << eekflag << endl;
+      }
+  }
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return 0;
+}
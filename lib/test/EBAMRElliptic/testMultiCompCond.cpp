@@ -0,0 +1,308 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <cmath>
+#include <cstring>
+
+#include "SphereIF.H"
+#include "GeometryShop.H"
+#include "EBIndexSpace.H"
+#include "EBISLayout.H"
+#include "EBCellFactory.H"
+#include "EBFluxFactory.H"
+#include "BaseIVFactory.H"
+#include "BoxIterator.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "EBLevelGrid.H"
+#include "EBQuadCFInterp.H"
+#include "EBConductivityOp.H"
+#include "EBConductivityOpFactory.H"
+#include "DirichletConductivityDomainBC.H"
+#include "DirichletConductivityEBBC.H"
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testMultiCompCond" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = false ;
+
+static const int  nCells  = 32;
+static const int  nComp   = 3;
+static const int  nGhost  = 4;
+
+/***************/
+//two levels, the finer one covering the middle of the domain, with
+//a sphere that crosses the coarse-fine interface
+void
+makeLevels(Vector<EBLevelGrid>& a_eblgs,
+           Real&                a_dxCoar)
+{
+  a_dxCoar = 1.0/nCells;
+  ProblemDomain domCoar(Box(IntVect::Zero, (nCells-1)*IntVect::Unit));
+  ProblemDomain domFine = refine(domCoar, 2);
+
+  SphereIF sphere(0.2, RealVect(D_DECL(0.45, 0.52, 0.5)), false);
+  GeometryShop gshop(sphere, 0, 0.5*a_dxCoar*RealVect::Unit);
+  Chombo_EBIS::instance()->define(domFine, RealVect::Zero, 0.5*a_dxCoar, gshop, 8, -1);
+
+  Vector<Box> boxes;
+  Vector<int> procs;
+  domainSplit(domCoar, boxes, 8, 4);
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout gridsCoar(boxes, procs, domCoar);
+
+  Box fineBox(nCells/4*IntVect::Unit, (3*nCells/4-1)*IntVect::Unit);
+  fineBox.refine(2);
+  boxes.resize(0);
+  domainSplit(fineBox, boxes, 8, 4);
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout gridsFine(boxes, procs, domFine);
+
+  a_eblgs.resize(2);
+  a_eblgs[0].define(gridsCoar, domCoar, nGhost, Chombo_EBIS::instance());
+  a_eblgs[1].define(gridsFine, domFine, nGhost, Chombo_EBIS::instance());
+}
+/***************/
+//operator factory for one component, with coefficients that depend on the component
+RefCountedPtr<EBConductivityOpFactory>
+makeFactory(const Vector<EBLevelGrid>& a_eblgs,
+            Real                       a_dxCoar,
+            int                        a_comp)
+{
+  int nlev = a_eblgs.size();
+  Vector<int> refRat(nlev, 2);
+  Vector<RefCountedPtr<EBQuadCFInterp> > quadCFI(nlev);
+  Vector<RefCountedPtr<LevelData<EBCellFAB> > >        acoef(nlev);
+  Vector<RefCountedPtr<LevelData<EBFluxFAB> > >        bcoef(nlev);
+  Vector<RefCountedPtr<LevelData<BaseIVFAB<Real> > > > bcoefIrreg(nlev);
+  for (int ilev = 0; ilev < nlev; ilev++)
+    {
+      const DisjointBoxLayout& grids = a_eblgs[ilev].getDBL();
+      const EBISLayout&        ebisl = a_eblgs[ilev].getEBISL();
+      if (ilev > 0)
+        {
+          quadCFI[ilev] = RefCountedPtr<EBQuadCFInterp>
+            (new EBQuadCFInterp(grids, a_eblgs[ilev-1].getDBL(), ebisl, a_eblgs[ilev-1].getEBISL(),
+                                a_eblgs[ilev-1].getDomain(), 2, 1, *a_eblgs[ilev].getCFIVS(),
+                                Chombo_EBIS::instance()));
+        }
+      else
+        {
+          quadCFI[ilev] = RefCountedPtr<EBQuadCFInterp>(new EBQuadCFInterp());
+        }
+      EBCellFactory cellFact(ebisl);
+      EBFluxFactory fluxFact(ebisl);
+      LayoutData<IntVectSet> irregSets(grids);
+      for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+        {
+          Box grownBox = grow(grids.get(dit()), nGhost) & a_eblgs[ilev].getDomain().domainBox();
+          irregSets[dit()] = ebisl[dit()].getIrregIVS(grownBox);
+        }
+      BaseIVFactory<Real> bivFact(ebisl, irregSets);
+      acoef[ilev]      = RefCountedPtr<LevelData<EBCellFAB> >
+        (new LevelData<EBCellFAB>(grids, 1, nGhost*IntVect::Unit, cellFact));
+      bcoef[ilev]      = RefCountedPtr<LevelData<EBFluxFAB> >
+        (new LevelData<EBFluxFAB>(grids, 1, nGhost*IntVect::Unit, fluxFact));
+      bcoefIrreg[ilev] = RefCountedPtr<LevelData<BaseIVFAB<Real> > >
+        (new LevelData<BaseIVFAB<Real> >(grids, 1, nGhost*IntVect::Unit, bivFact));
+
+      Real dx = a_dxCoar/(ilev == 0 ? 1 : 2);
+      for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+        {
+          (*acoef[ilev])[dit()].setVal(1.0 + 0.25*a_comp);
+          for (int idir = 0; idir < SpaceDim; idir++)
+            {
+              EBFaceFAB& bcoFAB = (*bcoef[ilev])[dit()][idir];
+              bcoFAB.setVal(1.0 + a_comp);
+              BaseFab<Real>& regBco = bcoFAB.getSingleValuedFAB();
+              for (BoxIterator bit(regBco.box()); bit.ok(); ++bit)
+                {
+                  regBco(bit(), 0) = (1.0 + a_comp)*(1.0 + 0.5*dx*bit()[0]);
+                }
+            }
+          (*bcoefIrreg[ilev])[dit()].setVal(1.0 + a_comp);
+        }
+    }
+
+  DirichletConductivityDomainBCFactory* domBC = new DirichletConductivityDomainBCFactory();
+  domBC->setValue(0.5 - 0.2*a_comp);
+  DirichletConductivityEBBCFactory* ebBC = new DirichletConductivityEBBCFactory();
+  ebBC->setValue(1.0 + 0.3*a_comp);
+  ebBC->setOrder(1);
+  RefCountedPtr<BaseDomainBCFactory> domBCPtr(domBC);
+  RefCountedPtr<BaseEBBCFactory>     ebBCPtr(ebBC);
+  return RefCountedPtr<EBConductivityOpFactory>
+    (new EBConductivityOpFactory(a_eblgs, quadCFI, 1.0, 1.0, acoef, bcoef, bcoefIrreg,
+                                 a_dxCoar, refRat, domBCPtr, ebBCPtr,
+                                 nGhost*IntVect::Unit, nGhost*IntVect::Unit, 0));
+}
+/***************/
+void
+fillPhi(LevelData<EBCellFAB>& a_phi,
+        const EBLevelGrid&    a_eblg,
+        Real                  a_dx)
+{
+  for (DataIterator dit = a_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
+    {
+      a_phi[dit()].setVal(0.0);
+      IntVectSet ivs(a_eblg.getDBL().get(dit()));
+      for (VoFIterator vofit(ivs, a_eblg.getEBISL()[dit()].getEBGraph()); vofit.ok(); ++vofit)
+        {
+          RealVect x = a_dx*(RealVect(vofit().gridIndex()) + 0.5*RealVect::Unit);
+          for (int icomp = 0; icomp < a_phi.nComp(); icomp++)
+            {
+              a_phi[dit()](vofit(), icomp) = sin(3.0*x[0] + icomp)*cos(2.0*x[1]) + 0.3*icomp;
+            }
+        }
+    }
+}
+/***************/
+//applyOpMultiComp has to agree with one applyOp per component.
+//level 0 touches the domain boundary, level 1 the coarse-fine interface.
+int
+multiCompTest(int a_level, bool a_homogeneous)
+{
+  Vector<EBLevelGrid> eblgs;
+  Real dxCoar;
+  makeLevels(eblgs, dxCoar);
+  const EBLevelGrid& eblg = eblgs[a_level];
+  const DisjointBoxLayout& grids = eblg.getDBL();
+  Real dx = (a_level == 0) ? dxCoar : 0.5*dxCoar;
+
+  Vector<RefCountedPtr<EBConductivityOpFactory> > factories(nComp);
+  Vector<EBConductivityOp*> ops(nComp);
+  for (int icomp = 0; icomp < nComp; icomp++)
+    {
+      factories[icomp] = makeFactory(eblgs, dxCoar, icomp);
+      ops[icomp] = dynamic_cast<EBConductivityOp*>(factories[icomp]->AMRnewOp(eblg.getDomain()));
+      ops[icomp]->setAlphaAndBeta(0.5*icomp, 1.0 - 0.2*icomp);
+    }
+
+  IntVect ghost = nGhost*IntVect::Unit;
+  EBCellFactory fact(eblg.getEBISL());
+  LevelData<EBCellFAB> phi(grids, nComp, ghost, fact);
+  LevelData<EBCellFAB> lph(grids, nComp, ghost, fact);
+  fillPhi(phi, eblg, dx);
+
+  RefCountedPtr<EBQuadCFInterp> quadCFI;
+  LevelData<EBCellFAB>* phiCoar = NULL;
+  LevelData<EBCellFAB>* phiCoarComp = NULL;
+  if (a_level > 0)
+    {
+      const EBLevelGrid& eblgCoar = eblgs[a_level-1];
+      quadCFI = RefCountedPtr<EBQuadCFInterp>
+        (new EBQuadCFInterp(grids, eblgCoar.getDBL(), eblg.getEBISL(), eblgCoar.getEBISL(),
+                            eblgCoar.getDomain(), 2, nComp, *eblg.getCFIVS(),
+                            Chombo_EBIS::instance()));
+      EBCellFactory factCoar(eblgCoar.getEBISL());
+      phiCoar     = new LevelData<EBCellFAB>(eblgCoar.getDBL(), nComp, ghost, factCoar);
+      phiCoarComp = new LevelData<EBCellFAB>(eblgCoar.getDBL(),     1, ghost, factCoar);
+      fillPhi(*phiCoar, eblgCoar, 2.0*dx);
+    }
+
+  EBConductivityOp::applyOpMultiComp(lph, phi, phiCoar, ops, quadCFI,
+                                     a_homogeneous, a_homogeneous);
+
+  Real maxDiff = 0, maxLph = 0;
+  LevelData<EBCellFAB> phiComp(grids, 1, ghost, fact);
+  LevelData<EBCellFAB> lphComp(grids, 1, ghost, fact);
+  for (int icomp = 0; icomp < nComp; icomp++)
+    {
+      Interval srcInt(icomp, icomp);
+      Interval dstInt(0, 0);
+      //same ghost cell values as the multi-component apply started from
+      fillPhi(phi, eblg, dx);
+      fillPhi(phiComp, eblg, dx);
+      phi.copyTo(srcInt, phiComp, dstInt);
+      if (phiCoar != NULL)
+        {
+          phiCoar->copyTo(srcInt, *phiCoarComp, dstInt);
+        }
+      ops[icomp]->applyOp(lphComp, phiComp, phiCoarComp, a_homogeneous, a_homogeneous);
+      for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+        {
+          IntVectSet ivs(grids.get(dit()));
+          for (VoFIterator vofit(ivs, eblg.getEBISL()[dit()].getEBGraph()); vofit.ok(); ++vofit)
+            {
+              Real single = lphComp[dit()](vofit(), 0);
+              Real multi  = lph[dit()](vofit(), icomp);
+              maxDiff = Max(maxDiff, Abs(single - multi));
+              maxLph  = Max(maxLph,  Abs(single));
+            }
+        }
+    }
+#ifdef CH_MPI
+  Real localDiff = maxDiff;
+  MPI_Allreduce(&localDiff, &maxDiff, 1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+  Real localLph = maxLph;
+  MPI_Allreduce(&localLph, &maxLph, 1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+#endif
+  if (verbose)
+    {
+      pout() << indent2 << "level = " << a_level << ", homogeneous = " << a_homogeneous
+             << ", max |L(phi)| = " << maxLph
+             << ", max multi-component difference = " << maxDiff << endl;
+    }
+
+  for (int icomp = 0; icomp < nComp; icomp++)
+    {
+      delete ops[icomp];
+    }
+  delete phiCoar;
+  delete phiCoarComp;
+  Chombo_EBIS::instance()->clear();
+  if (maxDiff > 1.0e-12*maxLph)
+    {
+      pout() << indent2 << "multi-component operator differs by " << maxDiff << endl;
+      return -1;
+    }
+  return 0;
+}
+/***************/
+int
+main(int argc, char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  int eekflag = 0;
+  //scoping trick
+  {
+    for (int iarg = 1; iarg < argc; iarg++)
+      {
+        if (strncmp(argv[iarg], "-v", 3) == 0)
+          {
+            verbose = true;
+          }
+      }
+    for (int ilev = 0; (ilev < 2) && (eekflag == 0); ilev++)
+      {
+        eekflag = multiCompTest(ilev, true);
+        if (eekflag == 0)
+          {
+            eekflag = multiCompTest(ilev, false);
+          }
+      }
+    if (eekflag == 0)
+      {
+        pout() << indent << pgmname << " passed." << endl;
+      }
+    else
+      {
+        pout() << indent << pgmname << " failed with error code " << eekflag << endl;
+      }
+  }
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return eekflag;
+}
@@ -0,0 +1,400 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <cmath>
+#include <cstring>
+
+#include "SphereIF.H"
+#include "GeometryShop.H"
+#include "EBIndexSpace.H"
+#include "EBISLayout.H"
+#include "EBCellFactory.H"
+#include "EBFluxFactory.H"
+#include "BaseIVFactory.H"
+#include "BoxIterator.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "EBLevelGrid.H"
+#include "EBLevelDataOps.H"
+#include "EBQuadCFInterp.H"
+#include "AMRMultiGrid.H"
+#include "BiCGStabSolver.H"
+#include "EBConductivityOp.H"
+#include "EBConductivityOpFactory.H"
+#include "DirichletConductivityDomainBC.H"
+#include "DirichletConductivityEBBC.H"
+#include "EBViscousTensorOp.H"
+#include "EBViscousTensorOpFactory.H"
+#include "DirichletViscousTensorDomainBC.H"
+#include "DirichletViscousTensorEBBC.H"
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "testSinglePrecisionRelax" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = false ;
+
+static const int  nCells  = 32;
+static const int  nGhost  = 4;
+static const Real solverEps = 1.0e-10;
+
+typedef AMRLevelOpFactory<LevelData<EBCellFAB> > EBCellOpFactory;
+typedef void (*SetSingleFunc)(bool);
+
+/***************/
+//one level with a sphere in the middle
+void
+makeLevel(Vector<EBLevelGrid>& a_eblgs,
+          Real&                a_dx)
+{
+  a_dx = 1.0/nCells;
+  ProblemDomain domain(Box(IntVect::Zero, (nCells-1)*IntVect::Unit));
+
+  SphereIF sphere(0.2, RealVect(D_DECL(0.45, 0.52, 0.5)), false);
+  GeometryShop gshop(sphere, 0, a_dx*RealVect::Unit);
+  Chombo_EBIS::instance()->define(domain, RealVect::Zero, a_dx, gshop, 16, -1);
+
+  Vector<Box> boxes;
+  Vector<int> procs;
+  domainSplit(domain, boxes, 16, 8);
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout grids(boxes, procs, domain);
+
+  a_eblgs.resize(1);
+  a_eblgs[0].define(grids, domain, nGhost, Chombo_EBIS::instance());
+}
+/***************/
+//variable coefficients, so that the relaxation coefficient differs from cell to cell
+void
+makeCoefficients(Vector<RefCountedPtr<LevelData<EBCellFAB> > >&        a_acoef,
+                 Vector<RefCountedPtr<LevelData<EBFluxFAB> > >&        a_bcoef,
+                 Vector<RefCountedPtr<LevelData<BaseIVFAB<Real> > > >& a_bcoefIrreg,
+                 const EBLevelGrid&                                    a_eblg,
+                 Real                                                  a_dx)
+{
+  const DisjointBoxLayout& grids = a_eblg.getDBL();
+  const EBISLayout&        ebisl = a_eblg.getEBISL();
+  EBCellFactory cellFact(ebisl);
+  EBFluxFactory fluxFact(ebisl);
+  LayoutData<IntVectSet> irregSets(grids);
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      Box grownBox = grow(grids.get(dit()), nGhost) & a_eblg.getDomain().domainBox();
+      irregSets[dit()] = ebisl[dit()].getIrregIVS(grownBox);
+    }
+  BaseIVFactory<Real> bivFact(ebisl, irregSets);
+  a_acoef.resize(1);
+  a_bcoef.resize(1);
+  a_bcoefIrreg.resize(1);
+  a_acoef[0]      = RefCountedPtr<LevelData<EBCellFAB> >
+    (new LevelData<EBCellFAB>(grids, 1, nGhost*IntVect::Unit, cellFact));
+  a_bcoef[0]      = RefCountedPtr<LevelData<EBFluxFAB> >
+    (new LevelData<EBFluxFAB>(grids, 1, nGhost*IntVect::Unit, fluxFact));
+  a_bcoefIrreg[0] = RefCountedPtr<LevelData<BaseIVFAB<Real> > >
+    (new LevelData<BaseIVFAB<Real> >(grids, 1, nGhost*IntVect::Unit, bivFact));
+
+  for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      (*a_acoef[0])[dit()].setVal(1.0);
+      for (int idir = 0; idir < SpaceDim; idir++)
+        {
+          EBFaceFAB& bcoFAB = (*a_bcoef[0])[dit()][idir];
+          bcoFAB.setVal(1.0);
+          BaseFab<Real>& regBco = bcoFAB.getSingleValuedFAB();
+          for (BoxIterator bit(regBco.box()); bit.ok(); ++bit)
+            {
+              regBco(bit(), 0) = 1.0 + 0.5*a_dx*bit()[0];
+            }
+        }
+      (*a_bcoefIrreg[0])[dit()].setVal(1.0);
+    }
+}
+/***************/
+//a*phi - div(b grad phi), alpha = 1 and beta = -1
+RefCountedPtr<EBCellOpFactory>
+makeConductivityFactory(const Vector<EBLevelGrid>& a_eblgs,
+                        Real                       a_dx)
+{
+  Vector<RefCountedPtr<LevelData<EBCellFAB> > >        acoef;
+  Vector<RefCountedPtr<LevelData<EBFluxFAB> > >        bcoef;
+  Vector<RefCountedPtr<LevelData<BaseIVFAB<Real> > > > bcoefIrreg;
+  makeCoefficients(acoef, bcoef, bcoefIrreg, a_eblgs[0], a_dx);
+  Vector<int> refRat(1, 2);
+  Vector<RefCountedPtr<EBQuadCFInterp> > quadCFI(1, RefCountedPtr<EBQuadCFInterp>(new EBQuadCFInterp()));
+
+  DirichletConductivityDomainBCFactory* domBC = new DirichletConductivityDomainBCFactory();
+  domBC->setValue(0.5);
+  DirichletConductivityEBBCFactory* ebBC = new DirichletConductivityEBBCFactory();
+  ebBC->setValue(1.0);
+  ebBC->setOrder(1);
+  RefCountedPtr<BaseDomainBCFactory> domBCPtr(domBC);
+  RefCountedPtr<BaseEBBCFactory>     ebBCPtr(ebBC);
+  //relaxation type 2 is the one with a single precision version
+  return RefCountedPtr<EBCellOpFactory>
+    (new EBConductivityOpFactory(a_eblgs, quadCFI, 1.0, -1.0, acoef, bcoef, bcoefIrreg,
+                                 a_dx, refRat, domBCPtr, ebBCPtr,
+                                 nGhost*IntVect::Unit, nGhost*IntVect::Unit, 2));
+}
+/***************/
+//same coefficients for the viscous tensor, with eta = lambda = b.
+//multigrid for this operator with a Dirichlet EB diverges once beta
+//gets big, so this is the small time step end of a backward Euler solve
+RefCountedPtr<EBCellOpFactory>
+makeViscousFactory(const Vector<EBLevelGrid>& a_eblgs,
+                   Real                       a_dx)
+{
+  Vector<RefCountedPtr<LevelData<EBCellFAB> > >        acoef;
+  Vector<RefCountedPtr<LevelData<EBFluxFAB> > >        eta, lambda;
+  Vector<RefCountedPtr<LevelData<BaseIVFAB<Real> > > > etaIrreg, lambdaIrreg;
+  makeCoefficients(acoef, eta, etaIrreg, a_eblgs[0], a_dx);
+  makeCoefficients(acoef, lambda, lambdaIrreg, a_eblgs[0], a_dx);
+  Vector<int> refRat(1, 2);
+
+  DirichletViscousTensorDomainBCFactory* domBC = new DirichletViscousTensorDomainBCFactory();
+  domBC->setValue(0.5);
+  DirichletViscousTensorEBBCFactory* ebBC = new DirichletViscousTensorEBBCFactory();
+  ebBC->setValue(1.0);
+  RefCountedPtr<BaseDomainBCFactory> domBCPtr(domBC);
+  RefCountedPtr<BaseEBBCFactory>     ebBCPtr(ebBC);
+  return RefCountedPtr<EBCellOpFactory>
+    (new EBViscousTensorOpFactory(a_eblgs, 1.0, -1.0e-3, acoef, eta, lambda, etaIrreg, lambdaIrreg,
+                                  a_dx, refRat, domBCPtr, ebBCPtr,
+                                  nGhost*IntVect::Unit, nGhost*IntVect::Unit));
+}
+/***************/
+void
+fillData(LevelData<EBCellFAB>& a_data,
+         const EBLevelGrid&    a_eblg,
+         Real                  a_dx,
+         Real                  a_shift)
+{
+  for (DataIterator dit = a_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
+    {
+      a_data[dit()].setVal(0.0);
+      IntVectSet ivs(a_eblg.getDBL().get(dit()));
+      for (VoFIterator vofit(ivs, a_eblg.getEBISL()[dit()].getEBGraph()); vofit.ok(); ++vofit)
+        {
+          RealVect x = a_dx*(RealVect(vofit().gridIndex()) + 0.5*RealVect::Unit);
+          for (int icomp = 0; icomp < a_data.nComp(); icomp++)
+            {
+              a_data[dit()](vofit(), icomp) = sin(3.0*x[0] + icomp + a_shift)*cos(2.0*x[1]) + 0.3*icomp;
+            }
+        }
+    }
+}
+/***************/
+//max over the valid vofs of |a_one - a_two|
+Real
+maxDifference(const LevelData<EBCellFAB>& a_one,
+              const LevelData<EBCellFAB>& a_two,
+              const EBLevelGrid&          a_eblg)
+{
+  Real maxDiff = 0;
+  for (DataIterator dit = a_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
+    {
+      IntVectSet ivs(a_eblg.getDBL().get(dit()));
+      for (VoFIterator vofit(ivs, a_eblg.getEBISL()[dit()].getEBGraph()); vofit.ok(); ++vofit)
+        {
+          for (int icomp = 0; icomp < a_one.nComp(); icomp++)
+            {
+              maxDiff = Max(maxDiff, Abs(a_one[dit()](vofit(), icomp) - a_two[dit()](vofit(), icomp)));
+            }
+        }
+    }
+#ifdef CH_MPI
+  Real localDiff = maxDiff;
+  MPI_Allreduce(&localDiff, &maxDiff, 1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+#endif
+  return maxDiff;
+}
+/***************/
+//one smoothing sweep with the single precision coefficients has to agree
+//with the double precision sweep to about float roundoff
+int
+relaxTest(const Vector<EBLevelGrid>& a_eblgs,
+          Real                       a_dx,
+          EBCellOpFactory&           a_factory,
+          SetSingleFunc              a_setSingle,
+          int                        a_ncomp,
+          const char*                a_name)
+{
+  const EBLevelGrid& eblg = a_eblgs[0];
+  IntVect ghost = nGhost*IntVect::Unit;
+  EBCellFactory fact(eblg.getEBISL());
+  LevelData<EBCellFAB> phiStart(eblg.getDBL(), a_ncomp, ghost, fact);
+  LevelData<EBCellFAB> phiDouble(eblg.getDBL(), a_ncomp, ghost, fact);
+  LevelData<EBCellFAB> phiSingle(eblg.getDBL(), a_ncomp, ghost, fact);
+  LevelData<EBCellFAB> rhs(eblg.getDBL(), a_ncomp, ghost, fact);
+  fillData(phiStart,  eblg, a_dx, 0.0);
+  fillData(phiDouble, eblg, a_dx, 0.0);
+  fillData(phiSingle, eblg, a_dx, 0.0);
+  fillData(rhs,       eblg, a_dx, 0.7);
+
+  AMRLevelOp<LevelData<EBCellFAB> >* op = a_factory.AMRnewOp(eblg.getDomain());
+  (*a_setSingle)(false);
+  op->relax(phiDouble, rhs, 2);
+  //the operator builds its single precision coefficients on the first relax
+  (*a_setSingle)(true);
+  op->relax(phiSingle, rhs, 2);
+  (*a_setSingle)(false);
+  delete op;
+
+  Real maxChange = maxDifference(phiDouble, phiStart, eblg);
+  Real maxDiff   = maxDifference(phiDouble, phiSingle, eblg);
+  if (verbose)
+    {
+      pout() << indent2 << a_name << ": max change in relax = " << maxChange
+             << ", max single precision difference = " << maxDiff << endl;
+    }
+  if ((maxChange == 0) || (maxDiff > 1.0e-5*maxChange))
+    {
+      pout() << indent2 << a_name << ": single precision relax differs by " << maxDiff << endl;
+      return -1;
+    }
+  return 0;
+}
+/***************/
+//the whole solve has to reach the same tolerance with either smoother
+int
+solveTest(const Vector<EBLevelGrid>& a_eblgs,
+          Real                       a_dx,
+          EBCellOpFactory&           a_factory,
+          SetSingleFunc              a_setSingle,
+          int                        a_ncomp,
+          const char*                a_name)
+{
+  const EBLevelGrid& eblg = a_eblgs[0];
+  IntVect ghost = nGhost*IntVect::Unit;
+  EBCellFactory fact(eblg.getEBISL());
+  LevelData<EBCellFAB> rhs(eblg.getDBL(), a_ncomp, ghost, fact);
+  LevelData<EBCellFAB> res(eblg.getDBL(), a_ncomp, ghost, fact);
+  fillData(rhs, eblg, a_dx, 0.7);
+  Vector<LevelData<EBCellFAB>*> rhsVec(1, &rhs);
+  Vector<LevelData<EBCellFAB>*> resVec(1, &res);
+  Vector<LevelData<EBCellFAB>*> phiVec(2);
+
+  Real finalNorm[2];
+  for (int isingle = 0; isingle < 2; isingle++)
+    {
+      (*a_setSingle)(isingle == 1);
+      BiCGStabSolver<LevelData<EBCellFAB> > bottomSolver;
+      bottomSolver.m_verbosity = 0;
+      AMRMultiGrid<LevelData<EBCellFAB> > solver;
+      solver.define(eblg.getDomain(), a_factory, &bottomSolver, 1);
+      solver.setSolverParameters(4, 4, 4, 1, 40, solverEps, 1.0e-15, 1.0e-30);
+      solver.m_verbosity = 0;
+
+      phiVec[isingle] = new LevelData<EBCellFAB>(eblg.getDBL(), a_ncomp, ghost, fact);
+      Vector<LevelData<EBCellFAB>*> phi(1, phiVec[isingle]);
+      EBLevelDataOps::setToZero(*phi[0]);
+      solver.init(phi, rhsVec, 0, 0);
+      Real initialNorm = solver.computeAMRResidual(resVec, phi, rhsVec, 0, 0);
+      solver.solve(phi, rhsVec, 0, 0, true);
+      finalNorm[isingle] = solver.computeAMRResidual(resVec, phi, rhsVec, 0, 0);
+      if (verbose)
+        {
+          pout() << indent2 << a_name << ": single = " << isingle
+                 << ", V-cycles = " << solver.m_numVCycles
+                 << ", residual reduced from " << initialNorm
+                 << " to " << finalNorm[isingle] << endl;
+        }
+      if (finalNorm[isingle] > solverEps*initialNorm)
+        {
+          pout() << indent2 << a_name << ": solve with single = " << isingle
+                 << " did not converge" << endl;
+          (*a_setSingle)(false);
+          for (int idel = 0; idel <= isingle; idel++)
+            {
+              delete phiVec[idel];
+            }
+          return -2;
+        }
+    }
+  (*a_setSingle)(false);
+
+  //both are converged solutions of the same double precision problem
+  EBLevelDataOps::setToZero(res);
+  Real maxPhi  = maxDifference(*phiVec[0], res, eblg);
+  Real maxDiff = maxDifference(*phiVec[0], *phiVec[1], eblg);
+  delete phiVec[0];
+  delete phiVec[1];
+  if (verbose)
+    {
+      pout() << indent2 << a_name << ": max solution difference = " << maxDiff << endl;
+    }
+  if (maxDiff > 1.0e-6*maxPhi)
+    {
+      pout() << indent2 << a_name << ": solutions differ by " << maxDiff << endl;
+      return -3;
+    }
+  return 0;
+}
+/***************/
+int
+singlePrecisionTest()
+{
+  Vector<EBLevelGrid> eblgs;
+  Real dx;
+  makeLevel(eblgs, dx);
+  int eekflag = 0;
+  {
+    RefCountedPtr<EBCellOpFactory> condFact = makeConductivityFactory(eblgs, dx);
+    SetSingleFunc condSingle = &EBConductivityOp::setSinglePrecisionRelax;
+    eekflag = relaxTest(eblgs, dx, *condFact, condSingle, 1, "conductivity");
+    if (eekflag == 0)
+      {
+        eekflag = solveTest(eblgs, dx, *condFact, condSingle, 1, "conductivity");
+      }
+  }
+  if (eekflag == 0)
+    {
+      RefCountedPtr<EBCellOpFactory> viscFact = makeViscousFactory(eblgs, dx);
+      SetSingleFunc viscSingle = &EBViscousTensorOp::setSinglePrecisionRelax;
+      eekflag = relaxTest(eblgs, dx, *viscFact, viscSingle, SpaceDim, "viscous tensor");
+      if (eekflag == 0)
+        {
+          eekflag = solveTest(eblgs, dx, *viscFact, viscSingle, SpaceDim, "viscous tensor");
+        }
+    }
+  Chombo_EBIS::instance()->clear();
+  return eekflag;
+}
+/***************/
+int
+main(int argc, char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  //scoping trick
+  {
+    for (int iarg = 1; iarg < argc; iarg++)
+      {
+        if (strncmp(argv[iarg], "-v", 3) == 0)
+          {
+            verbose = true;
+          }
+      }
+    int eekflag = singlePrecisionTest();
+    if (eekflag == 0)
+      {
+        pout() << indent << pgmname << " passed." << endl;
+      }
+    else
+      {
+        pout() << indent << pgmname << " failed with error code " << eekflag << endl;
+      }
+  }
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return 0;
+}
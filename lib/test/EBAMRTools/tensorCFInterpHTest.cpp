@@ -0,0 +1,199 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include <cmath>
+#include <cstring>
+
+#include "SphereIF.H"
+#include "GeometryShop.H"
+#include "EBIndexSpace.H"
+#include "EBISLayout.H"
+#include "EBCellFactory.H"
+#include "VoFIterator.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "EBLevelGrid.H"
+#include "EBLevelDataOps.H"
+#include "EBTensorCFInterp.H"
+#include "UsingNamespace.H"
+
+/// Global variables for handling output:
+static const char* pgmname = "tensorCFInterpHTest" ;
+static const char* indent = "   ";
+static const char* indent2 = "      " ;
+static bool verbose = false ;
+
+static const int  nCells  = 32;
+static const int  nGhost  = 4;
+
+/***************/
+//two levels, the finer one covering the middle of the domain, with
+//a sphere that crosses the low x side of the coarse-fine interface
+void
+makeLevels(EBLevelGrid& a_eblgCoar,
+           EBLevelGrid& a_eblgFine,
+           Real&        a_dxCoar)
+{
+  a_dxCoar = 1.0/nCells;
+  ProblemDomain domCoar(Box(IntVect::Zero, (nCells-1)*IntVect::Unit));
+  ProblemDomain domFine = refine(domCoar, 2);
+
+  SphereIF sphere(0.2, RealVect(D_DECL(0.3, 0.52, 0.5)), false);
+  GeometryShop gshop(sphere, 0, 0.5*a_dxCoar*RealVect::Unit);
+  Chombo_EBIS::instance()->define(domFine, RealVect::Zero, 0.5*a_dxCoar, gshop, 8, -1);
+
+  Vector<Box> boxes;
+  Vector<int> procs;
+  domainSplit(domCoar, boxes, 8, 4);
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout gridsCoar(boxes, procs, domCoar);
+
+  Box fineBox(nCells/4*IntVect::Unit, (3*nCells/4-1)*IntVect::Unit);
+  fineBox.refine(2);
+  boxes.resize(0);
+  domainSplit(fineBox, boxes, 8, 4);
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout gridsFine(boxes, procs, domFine);
+
+  a_eblgCoar.define(gridsCoar, domCoar, nGhost, Chombo_EBIS::instance());
+  a_eblgFine.define(gridsFine, domFine, nGhost, Chombo_EBIS::instance());
+}
+/***************/
+void
+fillPhi(LevelData<EBCellFAB>& a_phi,
+        const EBLevelGrid&    a_eblg,
+        Real                  a_dx)
+{
+  for (DataIterator dit = a_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
+    {
+      a_phi[dit()].setVal(0.0);
+      IntVectSet ivs(a_eblg.getDBL().get(dit()));
+      for (VoFIterator vofit(ivs, a_eblg.getEBISL()[dit()].getEBGraph()); vofit.ok(); ++vofit)
+        {
+          RealVect x = a_dx*(RealVect(vofit().gridIndex()) + 0.5*RealVect::Unit);
+          for (int icomp = 0; icomp < a_phi.nComp(); icomp++)
+            {
+              a_phi[dit()](vofit(), icomp) = sin(3.0*x[0] + icomp)*cos(2.0*x[1]) + 0.1*icomp;
+            }
+        }
+    }
+}
+/***************/
+//max over the valid cells and the first layer of ghost cells of |a_one - a_two|
+Real
+maxDifference(const LevelData<EBCellFAB>& a_one,
+              const LevelData<EBCellFAB>& a_two,
+              const EBLevelGrid&          a_eblg)
+{
+  Real maxDiff = 0;
+  for (DataIterator dit = a_eblg.getDBL().dataIterator(); dit.ok(); ++dit)
+    {
+      IntVectSet ivs(grow(a_eblg.getDBL().get(dit()), 1) & a_eblg.getDomain().domainBox());
+      for (VoFIterator vofit(ivs, a_eblg.getEBISL()[dit()].getEBGraph()); vofit.ok(); ++vofit)
+        {
+          for (int icomp = 0; icomp < a_one.nComp(); icomp++)
+            {
+              maxDiff = Max(maxDiff, Abs(a_one[dit()](vofit(), icomp) - a_two[dit()](vofit(), icomp)));
+            }
+        }
+    }
+#ifdef CH_MPI
+  Real localDiff = maxDiff;
+  MPI_Allreduce(&localDiff, &maxDiff, 1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+#endif
+  return maxDiff;
+}
+/***************/
+//coarseFineInterpH never builds or reads coarse data.  it has to give
+//the same ghost cells and tangential gradients, bit for bit, as
+//coarseFineInterp with zero coarse data
+int
+tensorCFInterpHTest()
+{
+  EBLevelGrid eblgCoar, eblgFine;
+  Real dxCoar;
+  makeLevels(eblgCoar, eblgFine, dxCoar);
+  const DisjointBoxLayout& gridsFine = eblgFine.getDBL();
+  const DisjointBoxLayout& gridsCoar = eblgCoar.getDBL();
+  int eekflag = 0;
+  {
+    EBTensorCFInterp interp(gridsFine, gridsCoar, eblgFine.getEBISL(), eblgCoar.getEBISL(),
+                            eblgCoar.getDomain(), 2, SpaceDim, 0.5*dxCoar, *eblgFine.getCFIVS());
+
+    IntVect ghost = nGhost*IntVect::Unit;
+    EBCellFactory factFine(eblgFine.getEBISL());
+    EBCellFactory factCoar(eblgCoar.getEBISL());
+    LevelData<EBCellFAB> phiInhomog(gridsFine, SpaceDim, ghost, factFine);
+    LevelData<EBCellFAB> phiHomog(  gridsFine, SpaceDim, ghost, factFine);
+    LevelData<EBCellFAB> gradInhomog(gridsFine, SpaceDim*SpaceDim, ghost, factFine);
+    LevelData<EBCellFAB> gradHomog(  gridsFine, SpaceDim*SpaceDim, ghost, factFine);
+    LevelData<EBCellFAB> zeroCoar(gridsCoar, SpaceDim, ghost, factCoar);
+    fillPhi(phiInhomog, eblgFine, 0.5*dxCoar);
+    fillPhi(phiHomog,   eblgFine, 0.5*dxCoar);
+    EBLevelDataOps::setToZero(gradInhomog);
+    EBLevelDataOps::setToZero(gradHomog);
+    EBLevelDataOps::setToZero(zeroCoar);
+
+    interp.coarseFineInterp(phiInhomog, gradInhomog, zeroCoar);
+    interp.coarseFineInterpH(phiHomog, gradHomog);
+
+    Real phiDiff  = maxDifference(phiInhomog,  phiHomog,  eblgFine);
+    Real gradDiff = maxDifference(gradInhomog, gradHomog, eblgFine);
+    if (verbose)
+      {
+        pout() << indent2 << "max ghost cell difference = " << phiDiff
+               << ", max tangential gradient difference = " << gradDiff << endl;
+      }
+    if (phiDiff != 0)
+      {
+        pout() << indent2 << "homogeneous interpolation differs by " << phiDiff << endl;
+        eekflag = -1;
+      }
+    else if (gradDiff != 0)
+      {
+        pout() << indent2 << "homogeneous tangential gradients differ by " << gradDiff << endl;
+        eekflag = -2;
+      }
+  }
+  Chombo_EBIS::instance()->clear();
+  return eekflag;
+}
+/***************/
+int
+main(int argc, char* argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  int eekflag = 0;
+  //scoping trick
+  {
+    for (int iarg = 1; iarg < argc; iarg++)
+      {
+        if (strncmp(argv[iarg], "-v", 3) == 0)
+          {
+            verbose = true;
+          }
+      }
+    eekflag = tensorCFInterpHTest();
+    if (eekflag == 0)
+      {
+        pout() << indent << pgmname << " passed." << endl;
+      }
+    else
+      {
+        pout() << indent << pgmname << " failed with error code " << eekflag << endl;
+      }
+  }
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+  return eekflag;
+}
@@ -23,6 +23,7 @@
 #include "SlabService.H"
 #include "BoxIterator.H"
 #include "BaseIVFAB.H"
+#include "MiniIVFAB.H"
 #include "BaseIFFAB.H"
 #include "BaseEBCellFAB.H"
 #include "BaseEBFaceFAB.H"
@@ -406,6 +407,45 @@ int checkFabIndex(const EBISLayout& a_ebisl,
             }
         }
     }
+  //now the MiniIVFAB that holds the irregular data of BaseEBCellFAB.
+  //the whole box goes through the slot table, a few cells through the
+  //linear search
+  for (DataIterator dit=a_grids.dataIterator(); dit.ok(); ++dit)
+    {
+      const Box& localBox = a_grids.get(dit());
+      const EBISBox& ebisBox = a_ebisl[dit()];
+      IntVectSet smallIVS;
+      smallIVS |= localBox.smallEnd();
+      smallIVS |= localBox.bigEnd();
+      IntVectSet sets[2];
+      sets[0] = IntVectSet(localBox);
+      sets[1] = smallIVS;
+      for (int iset = 0; iset < 2; iset++)
+        {
+          MiniIVFAB<int> miniivfab(sets[iset], ebisBox.getEBGraph(), nvar);
+          miniivfab.setVal(-100);
+          VoFIterator vofit(sets[iset], ebisBox.getEBGraph());
+          for (vofit.reset(); vofit.ok(); ++vofit)
+            {
+              for (int ivar = 0; ivar < nvar; ivar++)
+                {
+                  miniivfab(vofit(), ivar) = getFabVal(vofit().gridIndex(), ivar) + vofit().cellIndex();
+                }
+            }
+          for (vofit.reset(); vofit.ok(); ++vofit)
+            {
+              for (int ivar = 0; ivar < nvar; ivar++)
+                {
+                  int rightans = getFabVal(vofit().gridIndex(), ivar) + vofit().cellIndex();
+                  if (miniivfab(vofit(), ivar) != rightans)
+                    {
+                      eekflag = 6;
+                      return eekflag;
+                    }
+                }
+            }
+        }
+    }
   return eekflag;
 }
 #endif